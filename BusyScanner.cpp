@@ -0,0 +1,137 @@
+#include "BusyScanner.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// readlinkat() into a caller-owned buffer, no allocation on the hot path
+ssize_t readLink(int dir_fd, const char* name, char* buffer, size_t size) {
+    ssize_t len = readlinkat(dir_fd, name, buffer, size - 1);
+    if (len >= 0) buffer[len] = '\0';
+    return len;
+}
+
+}
+
+BusyScanner::Result BusyScanner::scan(const std::string& mount_point, int threads) {
+    auto started = std::chrono::steady_clock::now();
+    Result result;
+
+    std::string root = mount_point;
+    while (root.size() > 1 && root.back() == '/') root.pop_back();
+
+    // Our own fds (a warm-up still winding down, the scan itself) are not
+    // holders: they are released before the unmount gets going
+    const long self = getpid();
+
+    std::vector<int> pids;
+    if (DIR* proc = opendir("/proc")) {
+        while (struct dirent* entry = readdir(proc)) {
+            char* end;
+            long pid = strtol(entry->d_name, &end, 10);
+            if (*end == '\0' && pid > 0 && pid != self) pids.push_back(static_cast<int>(pid));
+        }
+        closedir(proc);
+    }
+    result.processes_scanned = static_cast<int>(pids.size());
+
+    if (threads <= 0) {
+        threads = std::min(8, std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+    }
+    threads = std::min(threads, std::max(1, static_cast<int>(pids.size())));
+
+    std::atomic<size_t> next{0};
+    std::mutex holders_mutex;
+    auto worker = [&]() {
+        Holder holder;
+        for (size_t i = next++; i < pids.size(); i = next++) {
+            if (checkProcess(pids[i], root, holder)) {
+                std::lock_guard<std::mutex> lock(holders_mutex);
+                result.holders.push_back(holder);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    std::sort(result.holders.begin(), result.holders.end(),
+              [](const Holder& a, const Holder& b) { return a.pid < b.pid; });
+    result.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+bool BusyScanner::isUnder(const std::string& path, const std::string& mount_point) {
+    if (path.compare(0, mount_point.size(), mount_point) != 0) return false;
+    return path.size() == mount_point.size() || path[mount_point.size()] == '/' || mount_point == "/";
+}
+
+bool BusyScanner::checkProcess(int pid, const std::string& mount_point, Holder& holder) {
+    char proc_path[64];
+    snprintf(proc_path, sizeof(proc_path), "/proc/%d", pid);
+    int proc_fd = open(proc_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (proc_fd < 0) return false;
+
+    char target[4096];
+    bool found = false;
+
+    for (const char* link : {"cwd", "root", "exe"}) {
+        if (readLink(proc_fd, link, target, sizeof(target)) > 0 && isUnder(target, mount_point)) {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        int fd_dir_fd = openat(proc_fd, "fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        DIR* fd_dir = fd_dir_fd >= 0 ? fdopendir(fd_dir_fd) : nullptr;
+        if (fd_dir) {
+            while (struct dirent* entry = readdir(fd_dir)) {
+                if (entry->d_name[0] == '.') continue;
+                // Sockets, pipes and anon inodes never live under a mount point
+                if (readLink(fd_dir_fd, entry->d_name, target, sizeof(target)) > 0 &&
+                    target[0] == '/' && isUnder(target, mount_point)) {
+                    found = true;
+                    break;
+                }
+            }
+            closedir(fd_dir);
+        } else if (fd_dir_fd >= 0) {
+            close(fd_dir_fd);
+        }
+    }
+
+    if (found) {
+        holder.pid = pid;
+        holder.path = target;
+        holder.command.clear();
+        int comm_fd = openat(proc_fd, "comm", O_RDONLY | O_CLOEXEC);
+        if (comm_fd >= 0) {
+            char comm[64];
+            ssize_t len = read(comm_fd, comm, sizeof(comm) - 1);
+            if (len > 0) {
+                if (comm[len - 1] == '\n') --len;
+                holder.command.assign(comm, len);
+            }
+            close(comm_fd);
+        }
+    }
+
+    close(proc_fd);
+    return found;
+}
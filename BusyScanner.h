@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Finds processes that keep a mount point busy by walking /proc/*/fd,
+// /proc/*/cwd, /proc/*/root and /proc/*/exe in parallel. The calling
+// process is never reported.
+class BusyScanner {
+public:
+    struct Holder {
+        int pid = 0;
+        std::string command;    // from /proc/<pid>/comm
+        std::string path;       // first offending path found
+    };
+
+    struct Result {
+        std::vector<Holder> holders;    // sorted by pid
+        int processes_scanned = 0;
+        long elapsed_us = 0;
+    };
+
+    // threads <= 0 picks one per CPU, capped at 8
+    static Result scan(const std::string& mount_point, int threads = 0);
+
+private:
+    static bool isUnder(const std::string& path, const std::string& mount_point);
+    static bool checkProcess(int pid, const std::string& mount_point, Holder& holder);
+};
@@ -1,13 +1,51 @@
 #include "HomeVPNCore.h"
 #include <fstream>
 #include <sstream>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <chrono>
-#include <iomanip>
+#include <algorithm>
 #include <curl/curl.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#include "RtNetlink.h"
+#include "NativeMount.h"
+
+namespace {
+
+// Splits a comma-separated config value, trimming blanks and dropping empty items
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// Deadline for an unmount command run against an unresponsive share
+const int DETACH_TIMEOUT_MS = 10000;
+
+// Prefix of last_error while a busy share blocks the unmount
+const char* const SHARE_BUSY_ERROR = "Share busy (";
+
+bool sameHolders(const std::vector<BusyScanner::Holder>& a, const std::vector<BusyScanner::Holder>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const BusyScanner::Holder& x, const BusyScanner::Holder& y) {
+                          return x.pid == y.pid && x.path == y.path;
+                      });
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point started) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+}
+
+}
 
 HomeVPNCore::HomeVPNCore() {
     // Initialize curl globally
@@ -20,6 +58,8 @@ HomeVPNCore::HomeVPNCore() {
 
 HomeVPNCore::~HomeVPNCore() {
     stopStatusMonitor();
+    warmer_.cancel();
+    status_page_.close();
 }
 
 bool HomeVPNCore::loadConfig(const std::string& config_path) {
@@ -32,10 +72,18 @@ bool HomeVPNCore::loadConfig(const std::string& config_path) {
     
     std::ifstream file(path);
     if (!file.is_open()) {
-        addLog("Config file not found, using defaults: " + path);
+        log(LogLevel::Warning, LogCategory::Config, {"Config file not found, using defaults: ", path});
         return false;
     }
     
+    auto parseInt = [this](const std::string& key, const std::string& value, int& field) {
+        try {
+            field = std::stoi(value);
+        } catch (...) {
+            log(LogLevel::Warning, LogCategory::Config, {"Invalid ", key, " value: ", value});
+        }
+    };
+
     std::string line;
     while (std::getline(file, line)) {
         if (line.empty() || line[0] == '#') continue;
@@ -56,10 +104,34 @@ bool HomeVPNCore::loadConfig(const std::string& config_path) {
             config_.vpn_connect_cmd = value;
         } else if (key == "vpn_disconnect_cmd" || key == "vpn_disconnect") {
             config_.vpn_disconnect_cmd = value;
+        } else if (key == "vpn_backend") {
+            config_.vpn_backend = value;
+        } else if (key == "vpn_interface") {
+            config_.vpn_interface = value;
+        } else if (key == "vpn_addresses") {
+            config_.vpn_addresses = value;
+        } else if (key == "vpn_routes") {
+            config_.vpn_routes = value;
         } else if (key == "mount_cmd") {
             config_.mount_cmd = value;
         } else if (key == "unmount_cmd") {
             config_.unmount_cmd = value;
+        } else if (key == "mount_point") {
+            config_.mount_point = value;
+        } else if (key == "mount_backend") {
+            config_.mount_backend = value;
+        } else if (key == "mount_fstype") {
+            config_.mount_fstype = value;
+        } else if (key == "mount_source") {
+            config_.mount_source = value;
+        } else if (key == "mount_options") {
+            config_.mount_options = value;
+        } else if (key == "unmount_flags") {
+            config_.unmount_flags = value;
+        } else if (key == "busy_unmount_policy") {
+            config_.busy_unmount_policy = value;
+        } else if (key == "lazy_unmount_cmd") {
+            config_.lazy_unmount_cmd = value;
         } else if (key == "check_ip_url") {
             config_.check_ip_url = value;
         } else if (key == "expected_ip") {
@@ -70,12 +142,48 @@ bool HomeVPNCore::loadConfig(const std::string& config_path) {
             try {
                 config_.status_check_interval = std::stoi(value);
             } catch (...) {
-                addLog("Invalid status_check_interval value: " + value);
+                log(LogLevel::Warning, LogCategory::Config, {"Invalid status_check_interval value: ", value});
             }
+        } else if (key == "log_level") {
+            config_.log_level = value;
+        } else if (key == "log_categories") {
+            config_.log_categories = value;
+        } else if (key == "status_page") {
+            config_.status_page = value;
+        } else if (key == "probe_timeout_ms") {
+            parseInt(key, value, config_.probe_timeout_ms);
+        } else if (key == "probe_retry_interval") {
+            parseInt(key, value, config_.probe_retry_interval);
+        } else if (key == "warmup_dirs") {
+            config_.warmup_dirs = value;
+        } else if (key == "warmup_depth") {
+            parseInt(key, value, config_.warmup_depth);
+        } else if (key == "warmup_threads") {
+            parseInt(key, value, config_.warmup_threads);
+        } else if (key == "warmup_timeout_ms") {
+            parseInt(key, value, config_.warmup_timeout_ms);
+        } else if (key == "warmup_max_entries") {
+            parseInt(key, value, config_.warmup_max_entries);
+        } else if (key == "auto_reconnect") {
+            parseInt(key, value, config_.auto_reconnect);
+        } else if (key == "reconnect_base_ms") {
+            parseInt(key, value, config_.reconnect_base_ms);
+        } else if (key == "reconnect_max_ms") {
+            parseInt(key, value, config_.reconnect_max_ms);
+        } else if (key == "reconnect_jitter_percent") {
+            parseInt(key, value, config_.reconnect_jitter_percent);
+        } else if (key == "reconnect_breaker_threshold") {
+            parseInt(key, value, config_.reconnect_breaker_threshold);
+        } else if (key == "reconnect_breaker_cooldown") {
+            parseInt(key, value, config_.reconnect_breaker_cooldown);
+        } else if (key == "reconnect_remount") {
+            parseInt(key, value, config_.reconnect_remount);
         }
     }
     
-    addLog("Configuration loaded from: " + path);
+    applyLogFilter();
+    applyReconnectOptions();
+    log(LogLevel::Info, LogCategory::Config, {"Configuration loaded from: ", path});
     return true;
 }
 
@@ -89,59 +197,125 @@ void HomeVPNCore::saveConfig(const std::string& config_path) {
     
     std::ofstream file(path);
     if (!file.is_open()) {
-        addLog("Failed to save config to: " + path);
+        log(LogLevel::Error, LogCategory::Config, {"Failed to save config to: ", path});
         return;
     }
     
     file << "# HomeVPN Configuration\n";
     file << "vpn_connect_cmd=" << config_.vpn_connect_cmd << "\n";
     file << "vpn_disconnect_cmd=" << config_.vpn_disconnect_cmd << "\n";
+    file << "vpn_backend=" << config_.vpn_backend << "\n";
+    file << "vpn_interface=" << config_.vpn_interface << "\n";
+    file << "vpn_addresses=" << config_.vpn_addresses << "\n";
+    file << "vpn_routes=" << config_.vpn_routes << "\n";
     file << "mount_cmd=" << config_.mount_cmd << "\n";
     file << "unmount_cmd=" << config_.unmount_cmd << "\n";
+    file << "mount_point=" << config_.mount_point << "\n";
+    file << "mount_backend=" << config_.mount_backend << "\n";
+    file << "mount_fstype=" << config_.mount_fstype << "\n";
+    file << "mount_source=" << config_.mount_source << "\n";
+    file << "mount_options=" << config_.mount_options << "\n";
+    file << "unmount_flags=" << config_.unmount_flags << "\n";
+    file << "busy_unmount_policy=" << config_.busy_unmount_policy << "\n";
+    file << "lazy_unmount_cmd=" << config_.lazy_unmount_cmd << "\n";
     file << "check_ip_url=" << config_.check_ip_url << "\n";
     file << "expected_ip=" << config_.expected_ip << "\n";
     file << "home_ip_prefix=" << config_.home_ip_prefix << "\n";
     file << "status_check_interval=" << config_.status_check_interval << "\n";
-    
-    addLog("Configuration saved to: " + path);
+    file << "log_level=" << config_.log_level << "\n";
+    file << "log_categories=" << config_.log_categories << "\n";
+    file << "status_page=" << config_.status_page << "\n";
+    file << "probe_timeout_ms=" << config_.probe_timeout_ms << "\n";
+    file << "probe_retry_interval=" << config_.probe_retry_interval << "\n";
+    file << "warmup_dirs=" << config_.warmup_dirs << "\n";
+    file << "warmup_depth=" << config_.warmup_depth << "\n";
+    file << "warmup_threads=" << config_.warmup_threads << "\n";
+    file << "warmup_timeout_ms=" << config_.warmup_timeout_ms << "\n";
+    file << "warmup_max_entries=" << config_.warmup_max_entries << "\n";
+    file << "auto_reconnect=" << config_.auto_reconnect << "\n";
+    file << "reconnect_base_ms=" << config_.reconnect_base_ms << "\n";
+    file << "reconnect_max_ms=" << config_.reconnect_max_ms << "\n";
+    file << "reconnect_jitter_percent=" << config_.reconnect_jitter_percent << "\n";
+    file << "reconnect_breaker_threshold=" << config_.reconnect_breaker_threshold << "\n";
+    file << "reconnect_breaker_cooldown=" << config_.reconnect_breaker_cooldown << "\n";
+    file << "reconnect_remount=" << config_.reconnect_remount << "\n";
+    
+    log(LogLevel::Info, LogCategory::Config, {"Configuration saved to: ", path});
 }
 
 void HomeVPNCore::connectVPN() {
-    addLog("Connecting to VPN...");
-    std::string result = executeCommand(config_.vpn_connect_cmd);
-    
-    // Wait a moment for connection to establish
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+    log(LogLevel::Info, LogCategory::Vpn, {"Connecting to VPN..."});
+    reconnect_.resume();
+    setTunnel(true);
     updateStatus();
 }
 
 void HomeVPNCore::disconnectVPN() {
-    addLog("Disconnecting from VPN...");
-    std::string result = executeCommand(config_.vpn_disconnect_cmd);
-    
-    // Wait a moment for disconnection
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    log(LogLevel::Info, LogCategory::Vpn, {"Disconnecting from VPN..."});
+    // A deliberate disconnect is not an outage
+    reconnect_.suspend();
+    remount_after_reconnect_.store(false);
+    setTunnel(false);
     updateStatus();
 }
 
+void HomeVPNCore::setTunnel(bool up) {
+    // A disconnect must not interleave with a reconnect attempt's down/up
+    std::lock_guard<std::mutex> lock(tunnel_mutex_);
+    auto started = std::chrono::steady_clock::now();
+
+    if (config_.vpn_backend == "netlink" && setTunnelNative(up)) {
+        log(LogLevel::Info, LogCategory::Vpn, {"VPN link ", up ? "up" : "down", " via netlink in ", millisecondsSince(started), " ms"});
+        return;
+    }
+
+    executeCommand(up ? config_.vpn_connect_cmd : config_.vpn_disconnect_cmd);
+    log(LogLevel::Info, LogCategory::Vpn, {"VPN ", up ? "connect" : "disconnect", " command took ", millisecondsSince(started), " ms"});
+
+    // Wait a moment for the connection to establish or go away
+    std::this_thread::sleep_for(std::chrono::seconds(up ? 2 : 1));
+}
+
 void HomeVPNCore::mountShare() {
     if (!status_.vpn_connected) {
-        addLog("ERROR: Cannot mount share - VPN not connected");
+        log(LogLevel::Error, LogCategory::Mount, {"Cannot mount share - VPN not connected"});
+        std::lock_guard<std::mutex> lock(status_mutex_);
         status_.last_error = "VPN not connected";
         notifyStatusChange();
         return;
     }
     
-    addLog("Mounting network share...");
-    std::string result = executeCommand(config_.mount_cmd);
-    
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    log(LogLevel::Info, LogCategory::Mount, {"Mounting network share..."});
+    if (config_.mount_backend != "native" || !mountNative()) {
+        std::string result = executeCommand(config_.mount_cmd);
+
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
     updateStatus();
+
+    if (status_.share_mounted) {
+        startWarmup();
+    }
 }
 
 void HomeVPNCore::unmountShare() {
-    addLog("Unmounting network share...");
-    std::string result = executeCommand(config_.unmount_cmd);
+    log(LogLevel::Info, LogCategory::Mount, {"Unmounting network share..."});
+    remount_after_reconnect_.store(false);
+    warmer_.cancel();
+
+    UnmountAction action;
+    {
+        // The monitor thread rewrites busy_holders in updateStatus()
+        std::lock_guard<std::mutex> lock(status_mutex_);
+        // An explicit request always reports who holds the share
+        status_.busy_holders.clear();
+        action = decideUnmount();
+        if (action == UnmountAction::Refuse) {
+            notifyStatusChange();
+            return;
+        }
+    }
+    runUnmount(action);
     
     std::this_thread::sleep_for(std::chrono::seconds(1));
     updateStatus();
@@ -162,9 +336,31 @@ void HomeVPNCore::updateStatus() {
     // If VPN disconnected, disable mount
     if (!status_.vpn_connected && status_.share_mounted) {
         // Try to unmount
-        executeCommand(config_.unmount_cmd);
-        status_.share_mounted = false;
-        addLog("VPN disconnected, unmounting share");
+        warmer_.cancel();
+        // A dead server would block a normal unmount on its path lookup,
+        // so an unresponsive share is detached regardless of holders
+        UnmountAction action = status_.share_responsive ? decideUnmount() : UnmountAction::Lazy;
+        bool unmounted = false;
+        if (!status_.share_responsive) {
+            unmounted = detachUnresponsiveShare();
+        } else if (action != UnmountAction::Refuse) {
+            runUnmount(action);
+            unmounted = true;
+            log(LogLevel::Info, LogCategory::Mount, {"VPN disconnected, unmounting share"});
+        } else if (old_status.busy_holders.empty()) {
+            log(LogLevel::Warning, LogCategory::Mount, {"VPN disconnected, share busy - left mounted"});
+        }
+        if (unmounted) {
+            status_.share_mounted = false;
+            if (config_.auto_reconnect && config_.reconnect_remount) {
+                remount_after_reconnect_.store(true);
+            }
+        }
+    }
+
+    if (!status_.share_mounted && !status_.busy_holders.empty()) {
+        status_.busy_holders.clear();
+        if (status_.last_error.rfind(SHARE_BUSY_ERROR, 0) == 0) status_.last_error = "";
     }
     
     // Clear error if status improved
@@ -174,12 +370,15 @@ void HomeVPNCore::updateStatus() {
     
     // Log status changes
     if (old_status.vpn_connected != status_.vpn_connected) {
-        addLog(status_.vpn_connected ? "VPN Connected" : "VPN Disconnected");
+        log(LogLevel::Info, LogCategory::Vpn, {status_.vpn_connected ? "VPN Connected" : "VPN Disconnected"});
     }
     
     if (old_status.share_mounted != status_.share_mounted) {
-        addLog(status_.share_mounted ? "Share Mounted" : "Share Unmounted");
+        log(LogLevel::Info, LogCategory::Mount, {status_.share_mounted ? "Share Mounted" : "Share Unmounted"});
     }
+
+    history_.record(status_.vpn_connected, status_.share_mounted, status_.probe_latency_ms,
+                    !status_.last_error.empty() || !status_.share_responsive);
     
     notifyStatusChange();
 }
@@ -189,22 +388,31 @@ void HomeVPNCore::startStatusMonitor() {
     
     monitor_running_.store(true);
     monitor_thread_ = std::thread(&HomeVPNCore::statusMonitorLoop, this);
-    addLog("Status monitor started");
+    uplink_thread_ = std::thread(&HomeVPNCore::uplinkWatchLoop, this);
+    log(LogLevel::Debug, LogCategory::Core, {"Status monitor started"});
 }
 
 void HomeVPNCore::stopStatusMonitor() {
     if (!monitor_running_.load()) return;
     
     monitor_running_.store(false);
+    wakeMonitor();
     if (monitor_thread_.joinable()) {
         monitor_thread_.join();
     }
-    addLog("Status monitor stopped");
+    if (uplink_thread_.joinable()) {
+        uplink_thread_.join();
+    }
+    log(LogLevel::Debug, LogCategory::Core, {"Status monitor stopped"});
 }
 
-const std::vector<std::string>& HomeVPNCore::getLogs() const {
+std::vector<std::string> HomeVPNCore::getLogs(const LogFilter& filter, size_t max_count) const {
+    std::vector<std::string> lines;
     std::lock_guard<std::mutex> lock(logs_mutex_);
-    return logs_;
+    logs_.visit(filter, max_count, [&lines](const LogRecord& record) {
+        lines.push_back(LogBuffer::format(record));
+    });
+    return lines;
 }
 
 void HomeVPNCore::clearLogs() {
@@ -220,38 +428,62 @@ void HomeVPNCore::setLogCallback(LogCallback callback) {
     log_callback_ = callback;
 }
 
-std::string HomeVPNCore::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto tm = *std::localtime(&time_t);
-    
-    std::stringstream ss;
-    ss << std::put_time(&tm, "%H:%M:%S");
-    return ss.str();
+bool HomeVPNCore::logEnabled(LogLevel level, LogCategory category) const {
+    return static_cast<uint8_t>(level) >= log_min_level_.load(std::memory_order_relaxed) &&
+           (log_categories_.load(std::memory_order_relaxed) & (1u << static_cast<unsigned>(category)));
 }
 
-void HomeVPNCore::addLog(const std::string& message) {
+void HomeVPNCore::log(LogLevel level, LogCategory category, std::initializer_list<LogArg> parts) {
+    // Filtered records cost two atomic loads, nothing is copied or formatted
+    if (!logEnabled(level, category)) return;
+
     std::lock_guard<std::mutex> lock(logs_mutex_);
-    
-    std::string timestamped_msg = getCurrentTimestamp() + ": " + message;
-    logs_.push_back(timestamped_msg);
-    
-    // Keep only last 100 log entries
-    if (logs_.size() > 100) {
-        logs_.erase(logs_.begin());
-    }
-    
+    const LogRecord& record = logs_.append(level, category, parts);
     if (log_callback_) {
-        log_callback_(timestamped_msg);
+        log_callback_(record);
     }
 }
 
+void HomeVPNCore::addLog(const std::string& message) {
+    log(LogLevel::Info, LogCategory::Core, {message});
+}
+
+void HomeVPNCore::applyLogFilter() {
+    LogLevel level;
+    if (parseLogLevel(config_.log_level, level)) {
+        log_min_level_.store(static_cast<uint8_t>(level));
+    } else {
+        log(LogLevel::Warning, LogCategory::Config, {"Invalid log_level value: ", config_.log_level});
+    }
+
+    uint32_t categories = 0;
+    for (const auto& name : splitList(config_.log_categories)) {
+        LogCategory category;
+        if (parseLogCategory(name, category)) {
+            categories |= 1u << static_cast<unsigned>(category);
+        } else {
+            log(LogLevel::Warning, LogCategory::Config, {"Invalid log category: ", name});
+        }
+    }
+    log_categories_.store(categories ? categories : LOG_ALL_CATEGORIES);
+}
+
+void HomeVPNCore::applyReconnectOptions() {
+    ReconnectPolicy::Options options;
+    options.base_delay_ms = std::max(config_.reconnect_base_ms, 0);
+    options.max_delay_ms = std::max(config_.reconnect_max_ms, options.base_delay_ms);
+    options.jitter = std::clamp(config_.reconnect_jitter_percent, 0, 100) / 100.0;
+    options.breaker_threshold = config_.reconnect_breaker_threshold;
+    options.breaker_cooldown_ms = std::max(config_.reconnect_breaker_cooldown, 0) * 1000;
+    reconnect_.setOptions(options);
+}
+
 std::string HomeVPNCore::executeCommand(const std::string& command) {
     std::string result;
     const std::unique_ptr<FILE, decltype(&pclose)> pipe(popen((command + " 2>&1").c_str(), "r"), pclose);
     
     if (!pipe) {
-        addLog("ERROR: Failed to execute command: " + command);
+        log(LogLevel::Error, LogCategory::Exec, {"Failed to execute command: ", command});
         return "Error: Failed to execute command";
     }
     
@@ -266,7 +498,7 @@ std::string HomeVPNCore::executeCommand(const std::string& command) {
     }
     
     if (!result.empty()) {
-        addLog("Command output: " + result);
+        log(LogLevel::Info, LogCategory::Exec, {"Command output: ", result});
     }
     
     return result;
@@ -315,25 +547,395 @@ bool HomeVPNCore::checkVPNConnection() {
 }
 
 bool HomeVPNCore::checkShareMount() {
-    // Simple check using mountpoint command
-    int result = system("mountpoint -q /mnt/homeshare 2>/dev/null");
-    return (result == 0);
+    // Probe out of process: a stat on a share whose server is gone can
+    // block in uninterruptible sleep, and we hold status_mutex_ here
+    const std::string& mount_point = config_.mount_point;
+    ProbeRunner::Result probe = probes_.run([&mount_point]() {
+        return ProbeRunner::isMountPoint(mount_point);
+    }, config_.probe_timeout_ms);
+    status_.probe_latency_ms = probe.elapsed_ms;
+
+    switch (probe.outcome) {
+        case ProbeRunner::Outcome::Ok:
+            if (probe.value < 0 && status_.share_mounted) {
+                // Fails fast (EIO, EHOSTDOWN, ...) but is still mounted
+                if (status_.share_responsive) {
+                    status_.share_responsive = false;
+                    status_.last_error = "Share unresponsive";
+                    log(LogLevel::Warning, LogCategory::Probe, {"Share unresponsive: ", strerror(-probe.value)});
+                }
+                break;
+            }
+            if (!status_.share_responsive) {
+                status_.share_responsive = true;
+                if (status_.last_error == "Share unresponsive") status_.last_error = "";
+                log(LogLevel::Info, LogCategory::Probe, {"Share responsive again (", probe.elapsed_ms, " ms)"});
+            }
+            return probe.value == 1;
+        case ProbeRunner::Outcome::TimedOut:
+        case ProbeRunner::Outcome::Saturated:
+            if (status_.share_responsive) {
+                status_.share_responsive = false;
+                status_.last_error = "Share unresponsive";
+                log(LogLevel::Warning, LogCategory::Probe, {"Share unresponsive: probe timed out after ", config_.probe_timeout_ms, " ms"});
+            }
+            break;
+        case ProbeRunner::Outcome::Failed:
+            log(LogLevel::Error, LogCategory::Probe, {"Failed to start share probe"});
+            break;
+    }
+
+    // Keep the last known state; an unresponsive share is still mounted
+    return status_.share_mounted;
+}
+
+HomeVPNCore::Status HomeVPNCore::getStatus() const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    return status_snapshot_;
 }
 
 void HomeVPNCore::notifyStatusChange() {
+    // Callers hold status_mutex_
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        status_snapshot_ = status_;
+    }
+    publishStatus();
     if (status_callback_) {
         status_callback_(status_);
     }
 }
 
+void HomeVPNCore::publishStatus() {
+    if (config_.status_page == "none") return;
+
+    if (!status_page_tried_.exchange(true)) {
+        std::string path = config_.status_page.empty() ? homevpn::defaultStatusPagePath() : config_.status_page;
+        if (!status_page_.open(path)) {
+            log(LogLevel::Warning, LogCategory::Core, {"Not publishing status to ", path, ": ", status_page_.lastError()});
+        }
+    }
+    if (!status_page_.isOpen()) return;
+
+    homevpn::StatusData data = {};
+    data.flags = homevpn::STATUS_PUBLISHER_RUNNING;
+    if (status_.vpn_connected) data.flags |= homevpn::STATUS_VPN_CONNECTED;
+    if (status_.share_mounted) data.flags |= homevpn::STATUS_SHARE_MOUNTED;
+    if (status_.share_responsive) data.flags |= homevpn::STATUS_SHARE_RESPONSIVE;
+    data.publisher_pid = static_cast<uint32_t>(getpid());
+    data.updated_unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    data.probe_latency_ms = static_cast<uint32_t>(status_.probe_latency_ms);
+    data.busy_processes = static_cast<uint32_t>(status_.busy_holders.size());
+    StatusHistory::Stats stats = history_.stats();
+    data.flaps = stats.flaps;
+    data.uptime_permille = static_cast<uint32_t>(stats.uptime_percent * 10.0);
+    snprintf(data.ip, sizeof(data.ip), "%s", status_.current_ip.c_str());
+    snprintf(data.last_error, sizeof(data.last_error), "%s", status_.last_error.c_str());
+
+    status_page_.publish(data);
+}
+
+void HomeVPNCore::startWarmup() {
+    if (config_.warmup_dirs.empty() || !status_.share_responsive) return;
+
+    ShareWarmer::Options options;
+    options.dirs = splitList(config_.warmup_dirs);
+    options.max_depth = config_.warmup_depth;
+    options.threads = config_.warmup_threads;
+    options.time_budget_ms = config_.warmup_timeout_ms;
+    options.max_entries = config_.warmup_max_entries;
+
+    log(LogLevel::Info, LogCategory::Mount, {"Warming up share metadata..."});
+    warmer_.start(config_.mount_point, options, [this](const ShareWarmer::Result& result) {
+        log(LogLevel::Info, LogCategory::Mount, {"Warm-up done: ", result.entries, " entries in ", result.directories,
+                                                 " directories, ", result.elapsed_ms, " ms, ", result.errors, " errors",
+                                                 result.budget_exhausted ? " (budget exhausted)" : ""});
+    });
+}
+
+HomeVPNCore::UnmountAction HomeVPNCore::decideUnmount() {
+    BusyScanner::Result scan = BusyScanner::scan(config_.mount_point);
+    // The monitor retries every cycle while the share stays busy; only
+    // report holders when they change so the log ring is not flooded
+    bool changed = !sameHolders(scan.holders, status_.busy_holders);
+    status_.busy_holders = scan.holders;
+
+    if (scan.holders.empty()) {
+        return UnmountAction::Clean;
+    }
+
+    if (changed) {
+        log(LogLevel::Warning, LogCategory::Mount, {"Share busy: ", scan.holders.size(), " process(es) hold files (scanned ",
+                                                     scan.processes_scanned, " in ", scan.elapsed_us / 1000.0, " ms)"});
+        for (const auto& holder : scan.holders) {
+            log(LogLevel::Warning, LogCategory::Mount, {"  ", holder.pid, " ", holder.command, ": ", holder.path});
+        }
+    }
+
+    if (config_.busy_unmount_policy == "force") {
+        return UnmountAction::Force;
+    }
+    if (config_.busy_unmount_policy == "lazy") {
+        // The native backend can always detach, the command backend needs lazy_unmount_cmd
+        if (config_.mount_backend == "native" || !config_.lazy_unmount_cmd.empty()) {
+            log(LogLevel::Info, LogCategory::Mount, {"Detaching busy share lazily"});
+            return UnmountAction::Lazy;
+        }
+        if (changed) log(LogLevel::Warning, LogCategory::Mount, {"lazy_unmount_cmd not set, not unmounting"});
+    }
+
+    status_.last_error = SHARE_BUSY_ERROR + std::to_string(scan.holders.size()) + " processes)";
+    return UnmountAction::Refuse;
+}
+
+void HomeVPNCore::runUnmount(UnmountAction action) {
+    if (config_.mount_backend == "native") {
+        std::string flags = action == UnmountAction::Lazy ? "detach"
+                          : action == UnmountAction::Force ? "force"
+                          : config_.unmount_flags;
+        NativeMount::Timing timing;
+        NativeMount::Error error;
+        char timing_text[160], error_text[256];
+        if (NativeMount::unmount(config_.mount_point, flags, timing, error)) {
+            log(LogLevel::Info, LogCategory::Mount, {"Share unmounted natively (", timing.describe(timing_text, sizeof(timing_text)), ")"});
+            return;
+        }
+        log(LogLevel::Warning, LogCategory::Mount, {"Native unmount failed: ", error.describe(error_text, sizeof(error_text)), ", using command"});
+    }
+
+    const std::string& command = action == UnmountAction::Lazy ? config_.lazy_unmount_cmd : config_.unmount_cmd;
+    if (command.empty()) {
+        log(LogLevel::Error, LogCategory::Mount, {"No unmount command configured"});
+        return;
+    }
+    executeCommand(command);
+}
+
+bool HomeVPNCore::detachUnresponsiveShare() {
+    log(LogLevel::Warning, LogCategory::Mount, {"VPN disconnected, detaching unresponsive share"});
+    if (config_.mount_backend == "native") {
+        // umount2() does not revalidate the mount point, so it returns at once
+        NativeMount::Timing timing;
+        NativeMount::Error error;
+        char timing_text[160], error_text[256];
+        if (NativeMount::unmount(config_.mount_point, "detach", timing, error)) {
+            log(LogLevel::Info, LogCategory::Mount, {"Share detached natively (", timing.describe(timing_text, sizeof(timing_text)), ")"});
+            return true;
+        }
+        log(LogLevel::Warning, LogCategory::Mount, {"Native detach failed: ", error.describe(error_text, sizeof(error_text)), ", using command"});
+    }
+
+    const std::string& command = config_.lazy_unmount_cmd.empty() ? config_.unmount_cmd : config_.lazy_unmount_cmd;
+    if (command.empty()) {
+        log(LogLevel::Error, LogCategory::Mount, {"No unmount command configured"});
+        return false;
+    }
+    // umount(8) resolves the path first, which can hang on a dead server
+    ProbeRunner::Result result = commands_.runCommand(command, DETACH_TIMEOUT_MS);
+    if (result.outcome == ProbeRunner::Outcome::Saturated) {
+        log(LogLevel::Error, LogCategory::Mount, {"Earlier unmount commands are still stuck, not starting another"});
+        return false;
+    }
+    if (result.outcome != ProbeRunner::Outcome::Ok) {
+        log(LogLevel::Error, LogCategory::Mount, {"Unmount command did not finish within ", DETACH_TIMEOUT_MS, " ms"});
+        return false;
+    }
+    if (result.value != 0) {
+        log(LogLevel::Warning, LogCategory::Mount, {"Unmount command exited with status ", result.value});
+        return false;
+    }
+    return true;
+}
+
+bool HomeVPNCore::mountNative() {
+    NativeMount::Timing timing;
+    NativeMount::Error error;
+    char timing_text[160], error_text[256];
+    if (NativeMount::mount(config_.mount_fstype, config_.mount_source, config_.mount_options,
+                           config_.mount_point, timing, error)) {
+        log(LogLevel::Info, LogCategory::Mount, {"Share mounted natively (", timing.describe(timing_text, sizeof(timing_text)), ")"});
+        return true;
+    }
+    log(LogLevel::Warning, LogCategory::Mount, {"Native mount failed: ", error.describe(error_text, sizeof(error_text)), " after ", timing.describe(timing_text, sizeof(timing_text)), ", using command"});
+    return false;
+}
+
+bool HomeVPNCore::setTunnelNative(bool up) {
+    if (config_.vpn_interface.empty()) {
+        log(LogLevel::Error, LogCategory::Vpn, {"vpn_backend=netlink needs vpn_interface, using command"});
+        return false;
+    }
+
+    RtNetlink netlink;
+    bool ok = true;
+    if (up) {
+        std::vector<std::string> added;
+        bool link_up = false;
+        for (const auto& address : splitList(config_.vpn_addresses)) {
+            ok = ok && netlink.addAddress(config_.vpn_interface, address);
+            if (ok) added.push_back(address);
+        }
+        ok = ok && (link_up = netlink.setLinkUp(config_.vpn_interface, true));
+        for (const auto& route : splitList(config_.vpn_routes)) {
+            ok = ok && netlink.addRoute(route, config_.vpn_interface);
+        }
+
+        if (!ok) {
+            // Undo what was applied so the command fallback starts from a clean
+            // interface; routes through it go away with the link
+            std::string error = netlink.lastError();
+            RtNetlink undo;
+            if (link_up) undo.setLinkUp(config_.vpn_interface, false);
+            for (const auto& address : added) {
+                undo.deleteAddress(config_.vpn_interface, address);
+            }
+            log(LogLevel::Warning, LogCategory::Vpn, {"Netlink backend failed (", error, "), rolled back, using command"});
+            return false;
+        }
+    } else {
+        // Routes through the interface go away with the link
+        ok = netlink.setLinkUp(config_.vpn_interface, false);
+        for (const auto& address : splitList(config_.vpn_addresses)) {
+            ok = ok && netlink.deleteAddress(config_.vpn_interface, address);
+        }
+    }
+
+    if (!ok) {
+        log(LogLevel::Warning, LogCategory::Vpn, {"Netlink backend failed (", netlink.lastError(), "), using command"});
+    }
+    return ok;
+}
+
+void HomeVPNCore::runReconnectPolicy() {
+    if (!config_.auto_reconnect) return;
+
+    if (status_.vpn_connected) {
+        if (reconnect_.connected()) {
+            ReconnectPolicy::Stats stats = reconnect_.stats();
+            log(LogLevel::Info, LogCategory::Vpn, {"VPN recovered after ", stats.last_outage_attempts, " attempt(s) in ",
+                                                   stats.last_recovery_s, " s (mean ", stats.mean_time_to_recovery_s, " s, ",
+                                                   stats.mean_attempts_per_outage, " attempts per outage over ",
+                                                   stats.recoveries, " recoveries)"});
+        }
+        if (remount_after_reconnect_.exchange(false) && !status_.share_mounted) {
+            log(LogLevel::Info, LogCategory::Mount, {"Remounting share after reconnect"});
+            mountShare();
+        }
+        return;
+    }
+
+    if (reconnect_.state() == ReconnectPolicy::State::Connected) {
+        reconnect_.disconnected();
+        log(LogLevel::Warning, LogCategory::Vpn, {"VPN dropped, reconnecting"});
+    }
+    if (!reconnect_.attemptDue()) return;
+
+    reconnect_.attemptStarted();
+    log(LogLevel::Info, LogCategory::Vpn, {"Reconnect attempt ", reconnect_.stats().attempts});
+    // A dropped tunnel usually still exists (a dead peer, a stale handshake),
+    // and e.g. wg-quick refuses to bring up an interface that is already
+    // there, so tear it down first
+    // disconnectVPN() may come in at any point; its teardown stands
+    auto cancelled = [this]() {
+        if (reconnect_.state() != ReconnectPolicy::State::Suspended) return false;
+        log(LogLevel::Info, LogCategory::Vpn, {"Reconnect cancelled"});
+        return true;
+    };
+    setTunnel(false);
+    if (cancelled()) return;
+    setTunnel(true);
+    updateStatus();
+    if (cancelled()) return;
+
+    if (status_.vpn_connected) {
+        // Record the recovery and remount now rather than a check interval later
+        runReconnectPolicy();
+        return;
+    }
+
+    reconnect_.attemptFailed();
+    auto delay_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        reconnect_.nextAttempt() - std::chrono::steady_clock::now()).count();
+    if (reconnect_.state() == ReconnectPolicy::State::CircuitOpen) {
+        log(LogLevel::Warning, LogCategory::Vpn, {"Reconnect failing, next attempt in ", delay_ms / 1000, " s unless the network changes"});
+    } else {
+        log(LogLevel::Info, LogCategory::Vpn, {"Reconnect failed, next attempt in ", delay_ms / 1000.0, " s"});
+    }
+}
+
+void HomeVPNCore::uplinkWatchLoop() {
+    UplinkMonitor monitor;
+    std::string watched;
+    std::string problem;    // last warning, logged once until it changes
+
+    std::string change;
+    while (monitor_running_.load()) {
+        // Follows the config, so auto_reconnect can be switched on at any time
+        std::string interface = config_.auto_reconnect ? config_.vpn_interface : "";
+        std::string warning;
+        if (interface.empty()) {
+            monitor.close();
+            // Without the tunnel's name its own link coming up would count as
+            // a network change and restart every attempt
+            if (config_.auto_reconnect) warning = "vpn_interface is not set, not watching for network changes";
+        } else if (!monitor.isOpen() || interface != watched) {
+            if (monitor.open(interface)) {
+                watched = interface;
+            } else {
+                warning = "Cannot watch for network changes: " + monitor.lastError();
+            }
+        }
+        if (warning != problem && !warning.empty()) {
+            log(LogLevel::Warning, LogCategory::Vpn, {warning});
+        }
+        problem = warning;
+        if (!monitor.isOpen()) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+
+        // Short timeout so stopStatusMonitor() is not held up
+        if (!monitor.wait(1000, change)) continue;
+
+        ReconnectPolicy::State state = reconnect_.state();
+        if (state != ReconnectPolicy::State::Retrying && state != ReconnectPolicy::State::CircuitOpen) continue;
+
+        log(LogLevel::Info, LogCategory::Vpn, {"Network changed (", change, "), retrying now"});
+        reconnect_.networkChanged();
+        wakeMonitor();
+    }
+}
+
+void HomeVPNCore::wakeMonitor() {
+    {
+        std::lock_guard<std::mutex> lock(monitor_mutex_);
+        monitor_wakeup_ = true;
+    }
+    monitor_cv_.notify_all();
+}
+
 void HomeVPNCore::statusMonitorLoop() {
     while (monitor_running_.load()) {
         updateStatus();
+        runReconnectPolicy();
         
-        // Wait for the configured interval
-        for (int i = 0; i < config_.status_check_interval && monitor_running_.load(); ++i) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+        // Wait for the configured interval, polling faster while the share
+        // is unresponsive so recovery is noticed soon after the tunnel returns
+        int interval = status_.share_responsive ? config_.status_check_interval : config_.probe_retry_interval;
+        auto wait = std::chrono::steady_clock::duration(std::chrono::seconds(interval));
+
+        // Never sleep past a due reconnect attempt
+        ReconnectPolicy::State state = reconnect_.state();
+        if (config_.auto_reconnect &&
+            (state == ReconnectPolicy::State::Retrying || state == ReconnectPolicy::State::CircuitOpen)) {
+            auto until_attempt = reconnect_.nextAttempt() - std::chrono::steady_clock::now();
+            wait = std::max(std::chrono::steady_clock::duration::zero(), std::min(wait, until_attempt));
         }
+
+        std::unique_lock<std::mutex> lock(monitor_mutex_);
+        monitor_cv_.wait_for(lock, wait, [this] { return monitor_wakeup_ || !monitor_running_.load(); });
+        monitor_wakeup_ = false;
     }
 }
 
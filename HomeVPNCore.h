@@ -9,30 +9,87 @@
 #include <mutex>
 #include <chrono>
 #include <atomic>
+#include <condition_variable>
+#include "ShareWarmer.h"
+#include "BusyScanner.h"
+#include "ProbeRunner.h"
+#include "StatusHistory.h"
+#include "StatusPublisher.h"
+#include "LogBuffer.h"
+#include "ReconnectPolicy.h"
 
 class HomeVPNCore {
 public:
     struct Config {
         std::string vpn_connect_cmd = "echo 'VPN Connect'";
         std::string vpn_disconnect_cmd = "echo 'VPN Disconnect'";
+
+        // "command" runs vpn_connect_cmd/vpn_disconnect_cmd; "netlink" toggles
+        // an existing vpn_interface in process and falls back to the commands
+        std::string vpn_backend = "command";
+        std::string vpn_interface = "";
+        std::string vpn_addresses = "";     // comma-separated CIDRs
+        std::string vpn_routes = "";        // comma-separated CIDRs or "default"
         std::string mount_cmd = "echo 'Mount'";
         std::string unmount_cmd = "echo 'Unmount'";
+        std::string mount_point = "/mnt/homeshare";
+
+        // "command" runs mount_cmd/unmount_cmd; "native" mounts in process
+        // with the new mount API and falls back to the commands
+        std::string mount_backend = "command";
+        std::string mount_fstype = "cifs";
+        std::string mount_source = "";      // e.g. //server/share
+        std::string mount_options = "";     // passed to the kernel, comma-separated
+        std::string unmount_flags = "";     // native clean unmount: "", "detach" and/or "force"
+
+        // What to do when processes still hold files on the share:
+        // "warn" refuses to unmount, "lazy" runs lazy_unmount_cmd,
+        // "force" runs unmount_cmd regardless
+        std::string busy_unmount_policy = "warn";
+        std::string lazy_unmount_cmd = "";
         std::string check_ip_url = "https://ipinfo.io/ip";
         std::string expected_ip = "";
         std::string home_ip_prefix = "192.168.1.";
         int status_check_interval = 30; // seconds
+        std::string log_level = "info";     // records below this level are not kept
+        std::string log_categories = "";    // comma-separated categories to keep, empty = all
+        std::string status_page = "";   // shared status file; empty = $XDG_RUNTIME_DIR/homevpn.status, "none" = off
+        int probe_timeout_ms = 2000;    // deadline for filesystem probes on the share
+        int probe_retry_interval = 2;   // seconds, status check interval while unresponsive
+
+        // Post-mount warm-up; disabled while warmup_dirs is empty
+        std::string warmup_dirs = "";   // comma-separated, relative to mount_point
+        int warmup_depth = 2;
+        int warmup_threads = 4;
+        int warmup_timeout_ms = 5000;
+        int warmup_max_entries = 20000;
+
+        // Reconnect after the tunnel drops: immediate retry, then exponential
+        // backoff with jitter; after reconnect_breaker_threshold failures in a
+        // row only one attempt per reconnect_breaker_cooldown seconds
+        int auto_reconnect = 0;
+        int reconnect_base_ms = 2000;
+        int reconnect_max_ms = 300000;
+        int reconnect_jitter_percent = 20;
+        int reconnect_breaker_threshold = 8;
+        int reconnect_breaker_cooldown = 600;   // seconds
+        int reconnect_remount = 1;      // remount the share if the drop unmounted it
     };
 
     struct Status {
         bool vpn_connected = false;
         bool share_mounted = false;
+        bool share_responsive = true;   // false while share probes time out
+        long probe_latency_ms = 0;
         std::string current_ip = "";
         std::string last_error = "";
+        std::vector<BusyScanner::Holder> busy_holders; // from the last unmount attempt
     };
 
     // Callback types for UI notifications
     using StatusCallback = std::function<void(const Status&)>;
-    using LogCallback = std::function<void(const std::string&)>;
+    // The record's message is only valid during the call
+    using LogCallback = std::function<void(const LogRecord&)>;
 
     explicit HomeVPNCore();
     ~HomeVPNCore();
@@ -41,7 +98,7 @@ public:
     bool loadConfig(const std::string& config_path = "");
     void saveConfig(const std::string& config_path = "");
     const Config& getConfig() const { return config_; }
-    void setConfig(const Config& config) { config_ = config; }
+    void setConfig(const Config& config) { config_ = config; applyLogFilter(); applyReconnectOptions(); }
 
     // Core operations
     void connectVPN();
@@ -55,24 +112,33 @@ public:
     void stopStatusMonitor();
     
     // Status access
-    const Status& getStatus() const { return status_; }
+    // Copy of the state last passed to the status callback; never waits for
+    // a status check in progress
+    Status getStatus() const;
+    const StatusHistory& getHistory() const { return history_; }
+    const ReconnectPolicy& getReconnectPolicy() const { return reconnect_; }
     
     // Logging
-    const std::vector<std::string>& getLogs() const;
+    void log(LogLevel level, LogCategory category, std::initializer_list<LogArg> parts);
+    bool logEnabled(LogLevel level, LogCategory category) const;
+    // Formatted lines of the newest max_count records matching filter, oldest first
+    std::vector<std::string> getLogs(const LogFilter& filter = LogFilter(), size_t max_count = 100) const;
     void clearLogs();
     
     // UI callbacks
     void setStatusCallback(StatusCallback callback);
     void setLogCallback(LogCallback callback);
     
-    // Utility functions
-    static std::string getCurrentTimestamp();
-    
 private:
     Config config_;
     Status status_;
-    std::vector<std::string> logs_;
+    Status status_snapshot_;
+    mutable std::mutex snapshot_mutex_;
+    StatusHistory history_;
+    LogBuffer logs_;
     mutable std::mutex logs_mutex_;
+    std::atomic<uint8_t> log_min_level_{static_cast<uint8_t>(LogLevel::Info)};
+    std::atomic<uint32_t> log_categories_{LOG_ALL_CATEGORIES};
     mutable std::mutex status_mutex_;
     
     StatusCallback status_callback_;
@@ -80,8 +146,23 @@ private:
     
     std::thread monitor_thread_;
     std::atomic<bool> monitor_running_{false};
+    std::mutex monitor_mutex_;
+    std::condition_variable monitor_cv_;
+    bool monitor_wakeup_ = false;
+
+    ReconnectPolicy reconnect_;
+    std::atomic<bool> remount_after_reconnect_{false};
+    std::thread uplink_thread_;
+    std::mutex tunnel_mutex_;   // held for a whole setTunnel()
+
+    ShareWarmer warmer_;
+    ProbeRunner probes_;
+    ProbeRunner commands_;  // separate, stuck share probes must not block an unmount
+    StatusPublisher status_page_;
+    std::atomic<bool> status_page_tried_{false};
     
 public:
+    // Plain info message from a frontend
     void addLog(const std::string& message);
 
 private:
@@ -90,6 +171,20 @@ private:
     bool checkVPNConnection();
     bool checkShareMount();
     void notifyStatusChange();
+    void applyLogFilter();
+    void applyReconnectOptions();
+    void runReconnectPolicy();
+    void uplinkWatchLoop();
+    void wakeMonitor();
+    void publishStatus();
+    void startWarmup();
+    enum class UnmountAction { Refuse, Clean, Lazy, Force };
+    UnmountAction decideUnmount();
+    void runUnmount(UnmountAction action);
+    bool detachUnresponsiveShare();
+    bool mountNative();
+    void setTunnel(bool up);    // no status update, no reconnect policy change
+    bool setTunnelNative(bool up);
     void statusMonitorLoop();
     
     // HTTP helper
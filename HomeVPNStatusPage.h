@@ -0,0 +1,135 @@
+#pragma once
+
+// Layout of the shared status page published by HomeVPNCore, plus a
+// header-only reader for status bars and shell prompts. The page is a
+// small file under $XDG_RUNTIME_DIR that readers mmap once; after that a
+// read is a few loads, and waiting for a change is a futex wait on the
+// sequence counter.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace homevpn {
+
+const uint32_t STATUS_PAGE_MAGIC = 0x4e505648; // "HVPN"
+const uint32_t STATUS_PAGE_VERSION = 1;
+
+enum StatusFlags : uint32_t {
+    STATUS_VPN_CONNECTED = 1u << 0,
+    STATUS_SHARE_MOUNTED = 1u << 1,
+    STATUS_SHARE_RESPONSIVE = 1u << 2,
+    STATUS_PUBLISHER_RUNNING = 1u << 3,     // cleared on clean exit; see publisherAlive()
+};
+
+// Everything a reader gets; copied out under the seqlock
+struct StatusData {
+    uint32_t flags;
+    uint32_t publisher_pid;
+    int64_t updated_unix_ms;
+    uint32_t probe_latency_ms;
+    uint32_t busy_processes;
+    uint32_t flaps;
+    uint32_t uptime_permille;
+    char ip[64];
+    char last_error[128];
+};
+
+struct StatusPage {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;          // sizeof(StatusPage) of the writer
+    uint32_t sequence;      // seqlock: odd while being written; also the futex word
+    StatusData data;
+};
+
+inline std::string defaultStatusPagePath() {
+    const char* runtime_dir = getenv("XDG_RUNTIME_DIR");
+    std::string dir = runtime_dir && *runtime_dir ? runtime_dir : "/run/user/" + std::to_string(getuid());
+    return dir + "/homevpn.status";
+}
+
+class StatusPageReader {
+public:
+    StatusPageReader() = default;
+    ~StatusPageReader() {
+        if (page_) munmap(const_cast<StatusPage*>(page_), sizeof(StatusPage));
+    }
+
+    StatusPageReader(const StatusPageReader&) = delete;
+    StatusPageReader& operator=(const StatusPageReader&) = delete;
+
+    bool open(const std::string& path = defaultStatusPagePath()) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        void* mapping = mmap(nullptr, sizeof(StatusPage), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) return false;
+
+        page_ = static_cast<const StatusPage*>(mapping);
+        if (page_->magic != STATUS_PAGE_MAGIC || page_->version != STATUS_PAGE_VERSION ||
+            page_->size < sizeof(StatusPage)) {
+            munmap(mapping, sizeof(StatusPage));
+            page_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    // Consistent snapshot; returns the sequence number it belongs to. If no
+    // consistent copy can be taken (a writer stuck mid-update), data is
+    // cleared, which reads as disconnected and stale.
+    uint32_t read(StatusData& data) const {
+        const int max_tries = 1000;
+        uint32_t before = 0;
+        for (int i = 0; i < max_tries; ++i) {
+            if (i > 0) sched_yield();
+            before = __atomic_load_n(&page_->sequence, __ATOMIC_ACQUIRE);
+            if (before & 1) continue;
+            memcpy(&data, const_cast<const StatusData*>(&page_->data), sizeof(data));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&page_->sequence, __ATOMIC_RELAXED) != before) continue;
+
+            data.ip[sizeof(data.ip) - 1] = '\0';
+            data.last_error[sizeof(data.last_error) - 1] = '\0';
+            return before;
+        }
+        memset(&data, 0, sizeof(data));
+        return before;
+    }
+
+    // False if the snapshot is stale: the publisher exited, or crashed and
+    // never cleared its running flag. Costs a syscall, unlike read().
+    static bool publisherAlive(const StatusData& data) {
+        if (!(data.flags & STATUS_PUBLISHER_RUNNING)) return false;
+        return data.publisher_pid == 0 ||
+               kill(static_cast<pid_t>(data.publisher_pid), 0) == 0 || errno != ESRCH;
+    }
+
+    // Blocks until the sequence moves past `sequence` or timeout_ms passes
+    // (negative waits forever). Returns false on timeout.
+    bool waitForChange(uint32_t sequence, int timeout_ms = -1) const {
+        struct timespec timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+        while (__atomic_load_n(&page_->sequence, __ATOMIC_ACQUIRE) == sequence) {
+            long result = syscall(SYS_futex, &page_->sequence, FUTEX_WAIT, sequence,
+                                  timeout_ms < 0 ? nullptr : &timeout, nullptr, 0);
+            if (result != 0 && errno == ETIMEDOUT) return false;
+        }
+        return true;
+    }
+
+private:
+    const StatusPage* page_ = nullptr;
+};
+
+}
@@ -2,6 +2,7 @@
 #include <gtk/gtk.h>
 #include <libayatana-appindicator/app-indicator.h>
 #include <memory>
+#include <atomic>
 
 class HomeVPN_GUI {
 private:
@@ -11,8 +12,16 @@ private:
     GtkWidget *window_{};
     GtkWidget *vpn_switch_{};
     GtkWidget *mount_switch_{};
+    GtkWidget *mount_label_{};
+    GtkWidget *busy_label_{};
+    GtkWidget *history_label_{};
     GtkWidget *log_textview_{};
     GtkTextBuffer *log_buffer_{};
+    GtkWidget *log_level_combo_{};
+    GtkWidget *log_category_combo_{};
+    // Log view filter, read from core threads
+    std::atomic<int> log_level_{static_cast<int>(LogLevel::Debug)};
+    std::atomic<int> log_category_{-1};     // -1 = all categories
     AppIndicator *indicator_{};
 
 public:
@@ -28,16 +37,19 @@ public:
             }, this);
         });
         
-        core_->setLogCallback([this](const std::string& message) {
+        core_->setLogCallback([this](const LogRecord& record) {
+            // Records hidden by the view filter are never formatted
+            if (!logFilter().matches(record.level, record.category)) return;
             g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, [](gpointer user_data) -> gboolean {
                 auto* data = static_cast<std::pair<HomeVPN_GUI*, std::string>*>(user_data);
                 data->first->onLogMessage(data->second);
                 delete data;
                 return G_SOURCE_REMOVE;
-            }, new std::pair<HomeVPN_GUI*, std::string>(this, message), nullptr);
+            }, new std::pair<HomeVPN_GUI*, std::string>(this, LogBuffer::format(record)), nullptr);
         });
         
         createWindow();
+        reloadLog();
         createTrayIndicator();
         
         // Start monitoring
@@ -83,18 +95,64 @@ private:
         GtkWidget *mount_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
         gtk_container_set_border_width(GTK_CONTAINER(mount_box), 10);
 
-        GtkWidget *mount_label = gtk_label_new("Mount Status:");
+        mount_label_ = gtk_label_new("Mount Status:");
         mount_switch_ = gtk_switch_new();
         gtk_widget_set_sensitive(mount_switch_, FALSE);
         g_signal_connect(mount_switch_, "notify::active", G_CALLBACK(onMountToggle), this);
 
-        gtk_box_pack_start(GTK_BOX(mount_box), mount_label, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(mount_box), mount_label_, FALSE, FALSE, 0);
         gtk_box_pack_end(GTK_BOX(mount_box), mount_switch_, FALSE, FALSE, 0);
-        gtk_container_add(GTK_CONTAINER(mount_frame), mount_box);
+        GtkWidget *mount_vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+        gtk_box_pack_start(GTK_BOX(mount_vbox), mount_box, FALSE, FALSE, 0);
+
+        // Processes keeping the share busy, only shown when there are any
+        busy_label_ = gtk_label_new(nullptr);
+        gtk_label_set_xalign(GTK_LABEL(busy_label_), 0.0);
+        gtk_label_set_line_wrap(GTK_LABEL(busy_label_), TRUE);
+        gtk_widget_set_margin_start(busy_label_, 10);
+        gtk_widget_set_margin_bottom(busy_label_, 10);
+        gtk_widget_set_no_show_all(busy_label_, TRUE);
+        gtk_box_pack_start(GTK_BOX(mount_vbox), busy_label_, FALSE, FALSE, 0);
+
+        gtk_container_add(GTK_CONTAINER(mount_frame), mount_vbox);
         gtk_box_pack_start(GTK_BOX(vbox), mount_frame, FALSE, FALSE, 0);
 
+        // Status history
+        GtkWidget *history_frame = gtk_frame_new("History (last hour)");
+        history_label_ = gtk_label_new(nullptr);
+        gtk_label_set_xalign(GTK_LABEL(history_label_), 0.0);
+        gtk_widget_set_margin_start(history_label_, 10);
+        gtk_widget_set_margin_end(history_label_, 10);
+        gtk_widget_set_margin_top(history_label_, 5);
+        gtk_widget_set_margin_bottom(history_label_, 5);
+        gtk_container_add(GTK_CONTAINER(history_frame), history_label_);
+        gtk_box_pack_start(GTK_BOX(vbox), history_frame, FALSE, FALSE, 0);
+
         // Log area
         GtkWidget *log_frame = gtk_frame_new("Log");
+        GtkWidget *log_vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+
+        GtkWidget *filter_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+        gtk_container_set_border_width(GTK_CONTAINER(filter_box), 5);
+        log_level_combo_ = gtk_combo_box_text_new();
+        for (int i = 0; i < 4; ++i) {
+            gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(log_level_combo_), logLevelName(static_cast<LogLevel>(i)));
+        }
+        gtk_combo_box_set_active(GTK_COMBO_BOX(log_level_combo_), log_level_.load());
+        log_category_combo_ = gtk_combo_box_text_new();
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(log_category_combo_), "all");
+        for (int i = 0; i < LOG_CATEGORY_COUNT; ++i) {
+            gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(log_category_combo_), logCategoryName(static_cast<LogCategory>(i)));
+        }
+        gtk_combo_box_set_active(GTK_COMBO_BOX(log_category_combo_), 0);
+        g_signal_connect(log_level_combo_, "changed", G_CALLBACK(onLogFilterChanged), this);
+        g_signal_connect(log_category_combo_, "changed", G_CALLBACK(onLogFilterChanged), this);
+        gtk_box_pack_start(GTK_BOX(filter_box), gtk_label_new("Level:"), FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(filter_box), log_level_combo_, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(filter_box), gtk_label_new("Category:"), FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(filter_box), log_category_combo_, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(log_vbox), filter_box, FALSE, FALSE, 0);
+
         GtkWidget *scrolled = gtk_scrolled_window_new(nullptr, nullptr);
         gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
         gtk_widget_set_size_request(scrolled, -1, 150);
@@ -105,7 +163,8 @@ private:
         log_buffer_ = gtk_text_view_get_buffer(GTK_TEXT_VIEW(log_textview_));
 
         gtk_container_add(GTK_CONTAINER(scrolled), log_textview_);
-        gtk_container_add(GTK_CONTAINER(log_frame), scrolled);
+        gtk_box_pack_start(GTK_BOX(log_vbox), scrolled, TRUE, TRUE, 0);
+        gtk_container_add(GTK_CONTAINER(log_frame), log_vbox);
         gtk_box_pack_start(GTK_BOX(vbox), log_frame, TRUE, TRUE, 0);
 
         gtk_widget_show_all(window_);
@@ -142,7 +201,23 @@ private:
         gtk_switch_set_active(GTK_SWITCH(vpn_switch_), status.vpn_connected);
         gtk_switch_set_active(GTK_SWITCH(mount_switch_), status.share_mounted);
         gtk_widget_set_sensitive(mount_switch_, status.vpn_connected);
+        gtk_label_set_text(GTK_LABEL(mount_label_),
+                           status.share_responsive ? "Mount Status:" : "Mount Status: (unresponsive)");
+
+        // Update busy process list
+        if (status.busy_holders.empty()) {
+            gtk_widget_hide(busy_label_);
+        } else {
+            std::string text = "Share in use by:";
+            for (const auto& holder : status.busy_holders) {
+                text += "\n" + std::to_string(holder.pid) + " " + holder.command + ": " + holder.path;
+            }
+            gtk_label_set_text(GTK_LABEL(busy_label_), text.c_str());
+            gtk_widget_show(busy_label_);
+        }
         
+        updateHistory();
+
         // Update tray icon
         const char* icon = status.vpn_connected ? "network-vpn" : "network-offline";
         app_indicator_set_icon(indicator_, icon);
@@ -152,6 +227,55 @@ private:
         g_signal_handlers_unblock_by_func(mount_switch_, (gpointer)onMountToggle, this);
     }
     
+    void updateHistory() {
+        const auto& history = core_->getHistory();
+        const size_t points = 60;  // minute buckets, matching the frame title
+        auto stats = history.stats();
+        auto latency = history.series(StatusHistory::Tier::Minute, StatusHistory::Metric::Latency, points);
+
+        std::string vpn = StatusHistory::sparkline(
+            history.series(StatusHistory::Tier::Minute, StatusHistory::Metric::Connected, points), 1.0f, true);
+        std::string share = StatusHistory::sparkline(
+            history.series(StatusHistory::Tier::Minute, StatusHistory::Metric::Mounted, points), 1.0f, true);
+        std::string lat = StatusHistory::sparkline(latency, 0.0f, true);
+
+        gchar *markup = g_markup_printf_escaped(
+            "<tt>VPN      %s\nShare    %s\nLatency  %s</tt>\n"
+            "Uptime %.1f%%, %u flaps, mean time to reconnect %.0f s",
+            vpn.c_str(), share.c_str(), lat.c_str(),
+            stats.uptime_percent, stats.flaps, stats.mean_time_to_reconnect_s);
+        std::string text = markup;
+        g_free(markup);
+
+        if (core_->getConfig().auto_reconnect) {
+            const auto& reconnect = core_->getReconnectPolicy();
+            auto reconnect_stats = reconnect.stats();
+            gchar *line = g_markup_printf_escaped(
+                "\nAuto-reconnect %s: %u recoveries, %.1f s mean, %.1f attempts per outage",
+                ReconnectPolicy::stateName(reconnect.state()), reconnect_stats.recoveries,
+                reconnect_stats.mean_time_to_recovery_s, reconnect_stats.mean_attempts_per_outage);
+            text += line;
+            g_free(line);
+        }
+        gtk_label_set_markup(GTK_LABEL(history_label_), text.c_str());
+    }
+
+    LogFilter logFilter() const {
+        LogFilter filter;
+        filter.min_level = static_cast<LogLevel>(log_level_.load());
+        int category = log_category_.load();
+        filter.categories = category < 0 ? LOG_ALL_CATEGORIES : 1u << category;
+        return filter;
+    }
+
+    // Re-renders the stored records that pass the current filter
+    void reloadLog() {
+        gtk_text_buffer_set_text(log_buffer_, "", -1);
+        for (const auto& line : core_->getLogs(logFilter(), 100)) {
+            onLogMessage(line);
+        }
+    }
+
     void onLogMessage(const std::string& message) {
         GtkTextIter end_iter;
         gtk_text_buffer_get_end_iter(log_buffer_, &end_iter);
@@ -181,6 +305,13 @@ private:
         g_application_quit(G_APPLICATION(gui->app_));
     }
 
+    static void onLogFilterChanged(GtkComboBox *combo, gpointer user_data) {
+        auto *gui = static_cast<HomeVPN_GUI*>(user_data);
+        gui->log_level_.store(gtk_combo_box_get_active(GTK_COMBO_BOX(gui->log_level_combo_)));
+        gui->log_category_.store(gtk_combo_box_get_active(GTK_COMBO_BOX(gui->log_category_combo_)) - 1);
+        gui->reloadLog();
+    }
+
     static void onVPNToggle(GObject *object, GParamSpec *pspec, gpointer user_data) {
         auto *gui = static_cast<HomeVPN_GUI*>(user_data);
         gboolean active = gtk_switch_get_active(GTK_SWITCH(object));
@@ -0,0 +1,113 @@
+// homevpn-status: prints the state published by a running HomeVPN_TUI or
+// HomeVPN_GUI, for status bars and shell prompts. Never probes anything.
+//
+// Exit status: 0 VPN connected, 1 VPN disconnected, 2 no status available or
+// the publisher is gone, so the last state it wrote is no longer true.
+
+#include "HomeVPNStatusPage.h"
+#include <cstdio>
+#include <ctime>
+#include <string>
+
+namespace {
+
+void usage() {
+    fprintf(stderr,
+            "Usage: homevpn-status [-j] [-s] [-w] [-p path]\n"
+            "  -j       print JSON (waybar custom module format)\n"
+            "  -s       print a short prompt segment\n"
+            "  -w       keep running and print on every change\n"
+            "  -p path  status page (default %s)\n",
+            homevpn::defaultStatusPagePath().c_str());
+}
+
+std::string jsonEscape(const char* text) {
+    std::string escaped;
+    for (const char* p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            escaped += '\\';
+            escaped += *p;
+        } else if (static_cast<unsigned char>(*p) < 0x20) {
+            escaped += ' ';
+        } else {
+            escaped += *p;
+        }
+    }
+    return escaped;
+}
+
+// Returns the exit status for this snapshot
+int print(const homevpn::StatusData& data, bool json, bool brief) {
+    // Nobody keeps a stale page up to date: the tunnel may be long gone
+    bool stale = !homevpn::StatusPageReader::publisherAlive(data);
+    bool vpn = !stale && (data.flags & homevpn::STATUS_VPN_CONNECTED);
+    bool mounted = !stale && (data.flags & homevpn::STATUS_SHARE_MOUNTED);
+    bool responsive = data.flags & homevpn::STATUS_SHARE_RESPONSIVE;
+    const char* share = stale ? "unknown" : !mounted ? "unmounted" : (responsive ? "mounted" : "unresponsive");
+
+    if (json) {
+        const char* css = stale ? "stale" : !vpn ? "disconnected" : (mounted && !responsive ? "degraded" : "connected");
+        printf("{\"text\": \"%s%s\", \"alt\": \"%s\", \"class\": \"%s\", "
+               "\"tooltip\": \"IP %s, share %s, uptime %.1f%%, %u flaps%s%s\"}\n",
+               stale ? "VPN?" : vpn ? "VPN" : "no VPN", mounted ? (responsive ? " +share" : " !share") : "",
+               css, css,
+               jsonEscape(data.ip).c_str(), share, data.uptime_permille / 10.0, data.flaps,
+               data.last_error[0] ? ", " : "", jsonEscape(data.last_error).c_str());
+    } else if (brief) {
+        printf("%s%s\n", vpn ? "vpn" : "", vpn && mounted ? (responsive ? "+share" : "!share") : "");
+    } else {
+        time_t updated = static_cast<time_t>(data.updated_unix_ms / 1000);
+        struct tm tm;
+        char when[16];
+        strftime(when, sizeof(when), "%H:%M:%S", localtime_r(&updated, &tm));
+        printf("VPN: %s  Share: %s  IP: %s  (updated %s%s)\n",
+               stale ? "unknown" : vpn ? "connected" : "disconnected", share, data.ip, when,
+               stale ? ", stale" : "");
+        if (data.last_error[0]) printf("Error: %s\n", data.last_error);
+    }
+    fflush(stdout);
+    return stale ? 2 : (vpn ? 0 : 1);
+}
+
+}
+
+int main(int argc, char** argv) {
+    bool json = false;
+    bool brief = false;
+    bool watch = false;
+    std::string path = homevpn::defaultStatusPagePath();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j") {
+            json = true;
+        } else if (arg == "-s") {
+            brief = true;
+        } else if (arg == "-w") {
+            watch = true;
+        } else if (arg == "-p" && i + 1 < argc) {
+            path = argv[++i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    homevpn::StatusPageReader reader;
+    if (!reader.open(path)) {
+        if (json) printf("{\"text\": \"\", \"class\": \"unavailable\"}\n");
+        return 2;
+    }
+
+    homevpn::StatusData data;
+    uint32_t sequence = reader.read(data);
+    int status = print(data, json, brief);
+
+    while (watch) {
+        reader.waitForChange(sequence);
+        sequence = reader.read(data);
+        status = print(data, json, brief);
+    }
+
+    return status;
+}
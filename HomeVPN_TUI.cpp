@@ -4,12 +4,18 @@
 #include <signal.h>
 #include <thread>
 #include <atomic>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
 
 class HomeVPN_TUI {
 private:
     std::unique_ptr<HomeVPNCore> core_;
     WINDOW *main_win_, *log_win_;
     int selected_item_ = 0;
+    StatusHistory::Tier history_tier_ = StatusHistory::Tier::Minute;
+    LogFilter log_filter_;
+    int log_category_ = -1;     // -1 = all categories
     std::atomic<bool> running_{true};
     std::atomic<bool> minimized_{false};
     std::atomic<bool> status_changed_{false};
@@ -25,7 +31,7 @@ public:
             status_changed_.store(true);
         });
         
-        core_->setLogCallback([this](const std::string& message) {
+        core_->setLogCallback([this](const LogRecord& record) {
             new_log_.store(true);
         });
         
@@ -100,7 +106,7 @@ private:
         const auto& status = core_->getStatus();
         int y = 1;
         wattron(main_win_, A_BOLD);
-        mvwprintw(main_win_, y++, 2, "HomeVPN TUI");
+        drawRow(y, 2, "HomeVPN TUI");
         wattroff(main_win_, A_BOLD);
         y++;
         // VPN status
@@ -110,37 +116,115 @@ private:
         if (selected_item_ == 0) mvwprintw(main_win_, y, width - 10, "<--");
         y++;
         // Mount status
-        wattron(main_win_, COLOR_PAIR(status.share_mounted ? 1 : 2));
-        mvwprintw(main_win_, y, 2, "[2] Share: %s", status.share_mounted ? "Mounted" : "Unmounted");
-        wattroff(main_win_, COLOR_PAIR(status.share_mounted ? 1 : 2));
+        int mount_color = !status.share_responsive ? 3 : (status.share_mounted ? 1 : 2);
+        wattron(main_win_, COLOR_PAIR(mount_color));
+        mvwprintw(main_win_, y, 2, "[2] Share: %s%s", status.share_mounted ? "Mounted" : "Unmounted",
+                  status.share_responsive ? "" : " (unresponsive)");
+        wattroff(main_win_, COLOR_PAIR(mount_color));
         if (selected_item_ == 1) mvwprintw(main_win_, y, width - 10, "<--");
         y++;
         // IP
         wattron(main_win_, COLOR_PAIR(4));
-        mvwprintw(main_win_, y++, 2, "IP: %s", status.current_ip.c_str());
+        drawRow(y, 2, "IP: %s", status.current_ip.c_str());
         wattroff(main_win_, COLOR_PAIR(4));
         // Error
         if (!status.last_error.empty()) {
             wattron(main_win_, COLOR_PAIR(3));
-            mvwprintw(main_win_, y++, 2, "Error: %s", status.last_error.c_str());
+            drawRow(y, 2, "Error: %s", status.last_error.c_str());
             wattroff(main_win_, COLOR_PAIR(3));
         }
+        // Processes keeping the share busy
+        if (!status.busy_holders.empty()) {
+            const size_t max_shown = 3;
+            wattron(main_win_, COLOR_PAIR(3));
+            for (size_t i = 0; i < status.busy_holders.size() && i < max_shown; ++i) {
+                const auto& holder = status.busy_holders[i];
+                drawRow(y, 4, "%d %s: %s", holder.pid, holder.command.c_str(), holder.path.c_str());
+            }
+            if (status.busy_holders.size() > max_shown) {
+                drawRow(y, 4, "... and %zu more", status.busy_holders.size() - max_shown);
+            }
+            wattroff(main_win_, COLOR_PAIR(3));
+        }
+        // Automatic reconnect
+        if (core_->getConfig().auto_reconnect) {
+            const auto& reconnect = core_->getReconnectPolicy();
+            auto state = reconnect.state();
+            auto stats = reconnect.stats();
+            if (state == ReconnectPolicy::State::Retrying || state == ReconnectPolicy::State::CircuitOpen) {
+                long wait_s = std::chrono::duration_cast<std::chrono::seconds>(
+                    reconnect.nextAttempt() - std::chrono::steady_clock::now()).count();
+                wattron(main_win_, COLOR_PAIR(3));
+                drawRow(y, 2, "Reconnect: %s, %u attempt(s), next in %lds",
+                          ReconnectPolicy::stateName(state), stats.attempts, std::max(wait_s, 0L));
+                wattroff(main_win_, COLOR_PAIR(3));
+            } else {
+                wattron(main_win_, COLOR_PAIR(4));
+                drawRow(y, 2, "Reconnect: %s  recoveries %u  MTTR %.1fs  %.1f attempts/outage",
+                          ReconnectPolicy::stateName(state), stats.recoveries,
+                          stats.mean_time_to_recovery_s, stats.mean_attempts_per_outage);
+                wattroff(main_win_, COLOR_PAIR(4));
+            }
+        }
         y++;
-        // Help
-        mvwprintw(main_win_, y++, 2, "[Up/Down] Select  [Enter/Space] Toggle  [q] Quit  [m] Minimize");
+        drawHistory(y, width);
+        // Help, always on the last row
+        mvwaddnstr(main_win_, getmaxy(main_win_) - 2, 2,
+                   "[Up/Dn] Select [Enter] Toggle [h] History [l/c] Log filter [m] Min [q] Quit",
+                   std::max(width - 4, 0));
         wrefresh(main_win_);
 
-        // Logs
-        const auto& logs = core_->getLogs();
+        // Logs, only the visible lines are formatted
         int log_lines = getmaxy(log_win_) - 2;
-        int start = logs.size() > log_lines ? logs.size() - log_lines : 0;
-        for (int i = 0; i < log_lines && (i + start) < (int)logs.size(); ++i) {
-            mvwprintw(log_win_, i + 1, 2, "%s", logs[i + start].c_str());
+        const auto logs = core_->getLogs(log_filter_, log_lines > 0 ? log_lines : 0);
+        for (int i = 0; i < (int)logs.size(); ++i) {
+            mvwprintw(log_win_, i + 1, 2, "%s", logs[i].c_str());
         }
-        mvwprintw(log_win_, 0, 2, "Log");
+        mvwprintw(log_win_, 0, 2, "Log [>= %s, %s]", logLevelName(log_filter_.min_level),
+                  log_category_ < 0 ? "all" : logCategoryName(static_cast<LogCategory>(log_category_)));
         wrefresh(log_win_);
     }
 
+    // Draws a main window row if it fits above the help row, cut to the
+    // window width; y advances either way
+    void drawRow(int& y, int x, const char* format, ...) {
+        char line[512];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        if (y <= getmaxy(main_win_) - 3) {
+            mvwaddnstr(main_win_, y, x, line, std::max(getmaxx(main_win_) - x - 1, 0));
+        }
+        y++;
+    }
+
+    void drawHistory(int y, int width) {
+        // Four rows or nothing, a cut-off sparkline block is just noise
+        if (y + 3 > getmaxy(main_win_) - 3) return;
+        const auto& history = core_->getHistory();
+        auto stats = history.stats();
+        const char* tier_name = history_tier_ == StatusHistory::Tier::Raw ? "samples"
+                              : history_tier_ == StatusHistory::Tier::Minute ? "minutes" : "hours";
+        drawRow(y, 2, "History (%s): uptime %.1f%%  flaps %u  MTTR %.0fs",
+                  tier_name, stats.uptime_percent, stats.flaps, stats.mean_time_to_reconnect_s);
+
+        size_t points = width > 24 ? std::min(width - 24, 120) : 0;
+        auto latency = history.series(history_tier_, StatusHistory::Metric::Latency, points);
+        float max_latency = 0.0f;
+        for (float v : latency) max_latency = std::max(max_latency, v);
+
+        std::string vpn = StatusHistory::sparkline(
+            history.series(history_tier_, StatusHistory::Metric::Connected, points), 1.0f, false);
+        std::string share = StatusHistory::sparkline(
+            history.series(history_tier_, StatusHistory::Metric::Mounted, points), 1.0f, false);
+        wattron(main_win_, COLOR_PAIR(4));
+        drawRow(y, 4, "VPN     |%s|", vpn.c_str());
+        drawRow(y, 4, "Share   |%s|", share.c_str());
+        drawRow(y, 4, "Latency |%s| %.0f ms", StatusHistory::sparkline(latency, 0.0f, false).c_str(), max_latency);
+        wattroff(main_win_, COLOR_PAIR(4));
+    }
+
     void handleInput() {
         int ch = getch();
         switch (ch) {
@@ -169,6 +253,21 @@ private:
                     }
                 }
                 break;
+            case 'h':
+            case 'H':
+                history_tier_ = history_tier_ == StatusHistory::Tier::Raw ? StatusHistory::Tier::Minute
+                              : history_tier_ == StatusHistory::Tier::Minute ? StatusHistory::Tier::Hour
+                              : StatusHistory::Tier::Raw;
+                break;
+            case 'l':
+            case 'L':
+                log_filter_.min_level = static_cast<LogLevel>((static_cast<int>(log_filter_.min_level) + 1) % 4);
+                break;
+            case 'c':
+            case 'C':
+                log_category_ = log_category_ + 1 < LOG_CATEGORY_COUNT ? log_category_ + 1 : -1;
+                log_filter_.categories = log_category_ < 0 ? LOG_ALL_CATEGORIES : 1u << log_category_;
+                break;
             case 'q':
             case 'Q':
                 running_.store(false);
@@ -0,0 +1,166 @@
+#include "LogBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+const char* const LEVEL_NAMES[] = {"debug", "info", "warning", "error"};
+const char* const CATEGORY_NAMES[] = {"core", "vpn", "exec", "probe", "mount", "config"};
+
+// Longest message kept; the rest is cut off
+const size_t MAX_MESSAGE_BYTES = 1024;
+
+}
+
+const char* logLevelName(LogLevel level) {
+    return LEVEL_NAMES[static_cast<int>(level)];
+}
+
+const char* logCategoryName(LogCategory category) {
+    return CATEGORY_NAMES[static_cast<int>(category)];
+}
+
+bool parseLogLevel(const std::string& name, LogLevel& level) {
+    for (int i = 0; i < 4; ++i) {
+        if (name == LEVEL_NAMES[i]) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseLogCategory(const std::string& name, LogCategory& category) {
+    for (int i = 0; i < LOG_CATEGORY_COUNT; ++i) {
+        if (name == CATEGORY_NAMES[i]) {
+            category = static_cast<LogCategory>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+LogArg::LogArg(long long value) {
+    int length = snprintf(digits_, sizeof(digits_), "%lld", value);
+    text_ = std::string_view(digits_, length);
+}
+
+LogArg::LogArg(unsigned long long value) {
+    int length = snprintf(digits_, sizeof(digits_), "%llu", value);
+    text_ = std::string_view(digits_, length);
+}
+
+LogArg::LogArg(double value) {
+    int length = snprintf(digits_, sizeof(digits_), "%.1f", value);
+    text_ = std::string_view(digits_, std::min<size_t>(length, sizeof(digits_) - 1));
+}
+
+LogArg& LogArg::operator=(const LogArg& other) {
+    if (other.text_.data() == other.digits_) {
+        memcpy(digits_, other.digits_, sizeof(digits_));
+        text_ = std::string_view(digits_, other.text_.size());
+    } else {
+        text_ = other.text_;
+    }
+    return *this;
+}
+
+LogBuffer::LogBuffer(size_t arena_bytes, size_t max_records)
+    : arena_(std::max(arena_bytes, MAX_MESSAGE_BYTES)), slots_(std::max<size_t>(max_records, 1)) {
+}
+
+const LogRecord& LogBuffer::append(LogLevel level, LogCategory category, std::initializer_list<LogArg> parts) {
+    size_t length = 0;
+    for (const auto& part : parts) length += part.view().size();
+    length = std::min(length, MAX_MESSAGE_BYTES);
+
+    // Messages never wrap around the end of the arena
+    size_t capacity = arena_.size();
+    size_t position = write_offset_ % capacity;
+    if (position + length > capacity) {
+        write_offset_ += capacity - position;
+        position = 0;
+    }
+
+    // Free the arena range and the slot we are about to reuse
+    while (count_ > 0 && slots_[head_].offset + capacity < write_offset_ + length) {
+        dropOldest();
+    }
+    if (count_ == slots_.size()) {
+        dropOldest();
+    }
+
+    char* out = arena_.data() + position;
+    size_t remaining = length;
+    for (const auto& part : parts) {
+        size_t n = std::min(part.view().size(), remaining);
+        memcpy(out, part.view().data(), n);
+        out += n;
+        remaining -= n;
+    }
+
+    Slot& slot = slots_[(head_ + count_) % slots_.size()];
+    slot.offset = write_offset_;
+    slot.record.monotonic_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    slot.record.wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    slot.record.level = level;
+    slot.record.category = category;
+    slot.record.message = std::string_view(arena_.data() + position, length);
+    count_++;
+    write_offset_ += length;
+
+    return slot.record;
+}
+
+void LogBuffer::visit(const LogFilter& filter, size_t max_count,
+                      const std::function<void(const LogRecord&)>& visitor) const {
+    // Walk back from the newest record to find where the matching window starts
+    size_t first = count_;
+    size_t matched = 0;
+    while (first > 0 && matched < max_count) {
+        const LogRecord& record = slots_[(head_ + first - 1) % slots_.size()].record;
+        if (filter.matches(record.level, record.category)) matched++;
+        first--;
+    }
+
+    for (size_t i = first; i < count_; ++i) {
+        const LogRecord& record = slots_[(head_ + i) % slots_.size()].record;
+        if (filter.matches(record.level, record.category)) visitor(record);
+    }
+}
+
+void LogBuffer::clear() {
+    head_ = 0;
+    count_ = 0;
+}
+
+std::string LogBuffer::format(const LogRecord& record, bool plain) {
+    time_t seconds = static_cast<time_t>(record.wall_ms / 1000);
+    struct tm tm;
+    localtime_r(&seconds, &tm);
+
+    char prefix[64];
+    size_t length = strftime(prefix, sizeof(prefix), "%H:%M:%S", &tm);
+    if (plain) {
+        length += snprintf(prefix + length, sizeof(prefix) - length, ": ");
+    } else {
+        length += snprintf(prefix + length, sizeof(prefix) - length, " %-7s %s: ",
+                           logLevelName(record.level), logCategoryName(record.category));
+    }
+
+    std::string line;
+    line.reserve(length + record.message.size());
+    line.append(prefix, length);
+    line.append(record.message);
+    return line;
+}
+
+void LogBuffer::dropOldest() {
+    head_ = (head_ + 1) % slots_.size();
+    count_--;
+}
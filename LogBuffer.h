@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <initializer_list>
+#include <functional>
+#include <vector>
+
+enum class LogLevel : uint8_t { Debug, Info, Warning, Error };
+enum class LogCategory : uint8_t { Core, Vpn, Exec, Probe, Mount, Config };
+
+const int LOG_CATEGORY_COUNT = 6;
+const uint32_t LOG_ALL_CATEGORIES = (1u << LOG_CATEGORY_COUNT) - 1;
+
+const char* logLevelName(LogLevel level);
+const char* logCategoryName(LogCategory category);
+bool parseLogLevel(const std::string& name, LogLevel& level);
+bool parseLogCategory(const std::string& name, LogCategory& category);
+
+struct LogFilter {
+    LogLevel min_level = LogLevel::Debug;
+    uint32_t categories = LOG_ALL_CATEGORIES;   // bit per LogCategory
+
+    bool matches(LogLevel level, LogCategory category) const {
+        return level >= min_level && (categories & (1u << static_cast<unsigned>(category)));
+    }
+};
+
+// A stored record; message points into the buffer's arena and is only
+// valid while the buffer is not modified
+struct LogRecord {
+    int64_t monotonic_ns = 0;
+    int64_t wall_ms = 0;        // Unix time
+    LogLevel level = LogLevel::Info;
+    LogCategory category = LogCategory::Core;
+    std::string_view message;
+};
+
+// One piece of a log message. Numbers are converted into an inline buffer,
+// so building a message never allocates.
+class LogArg {
+public:
+    LogArg(std::string_view text) : text_(text) {}
+    LogArg(const std::string& text) : text_(text) {}
+    LogArg(const char* text) : text_(text ? text : "") {}
+    LogArg(int value) : LogArg(static_cast<long long>(value)) {}
+    LogArg(long value) : LogArg(static_cast<long long>(value)) {}
+    LogArg(unsigned value) : LogArg(static_cast<unsigned long long>(value)) {}
+    LogArg(unsigned long value) : LogArg(static_cast<unsigned long long>(value)) {}
+    LogArg(long long value);
+    LogArg(unsigned long long value);
+    LogArg(double value);   // one decimal
+
+    LogArg(const LogArg& other) { *this = other; }
+    LogArg& operator=(const LogArg& other);
+
+    std::string_view view() const { return text_; }
+
+private:
+    char digits_[32];
+    std::string_view text_;
+};
+
+// Fixed-size log store: records in a ring, message bytes in a preallocated
+// arena that is reused in order. Old records are dropped when either is
+// full. Not thread-safe; the owner serialises access.
+class LogBuffer {
+public:
+    explicit LogBuffer(size_t arena_bytes = 16 * 1024, size_t max_records = 256);
+
+    const LogRecord& append(LogLevel level, LogCategory category, std::initializer_list<LogArg> parts);
+
+    // Calls visitor for the newest max_count records matching filter, oldest first
+    void visit(const LogFilter& filter, size_t max_count,
+               const std::function<void(const LogRecord&)>& visitor) const;
+
+    void clear();
+    size_t size() const { return count_; }
+
+    // "HH:MM:SS: message" in local time, plus level/category tags unless plain
+    static std::string format(const LogRecord& record, bool plain = false);
+
+private:
+    struct Slot {
+        LogRecord record;
+        uint64_t offset;    // position in the unbounded arena stream
+    };
+
+    std::vector<char> arena_;
+    std::vector<Slot> slots_;
+    size_t head_ = 0;       // oldest slot
+    size_t count_ = 0;
+    uint64_t write_offset_ = 0;
+
+    void dropOldest();
+};
@@ -0,0 +1,216 @@
+#include "NativeMount.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mount.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// glibc before 2.36 has neither the wrappers nor the constants
+#ifndef FSOPEN_CLOEXEC
+#include <linux/mount.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double since(Clock::time_point& started) {
+    auto now = Clock::now();
+    double ms = std::chrono::duration<double, std::milli>(now - started).count();
+    started = now;
+    return ms;
+}
+
+int sysFsopen(const char* fstype, unsigned int flags) {
+    return static_cast<int>(syscall(__NR_fsopen, fstype, flags));
+}
+
+int sysFsconfig(int fd, unsigned int cmd, const char* key, const void* value, int aux) {
+    return static_cast<int>(syscall(__NR_fsconfig, fd, cmd, key, value, aux));
+}
+
+int sysFsmount(int fd, unsigned int flags, unsigned int attr_flags) {
+    return static_cast<int>(syscall(__NR_fsmount, fd, flags, attr_flags));
+}
+
+int sysMoveMount(int from_fd, const char* from_path, int to_fd, const char* to_path, unsigned int flags) {
+    return static_cast<int>(syscall(__NR_move_mount, from_fd, from_path, to_fd, to_path, flags));
+}
+
+int sysOpenTree(int fd, const char* path, unsigned int flags) {
+    return static_cast<int>(syscall(__NR_open_tree, fd, path, flags));
+}
+
+// Drains the fs context log ("e cifs: ..." lines) for error reporting
+std::string readContextLog(int fs_fd) {
+    std::string log;
+    char buffer[256];
+    ssize_t length;
+    while ((length = read(fs_fd, buffer, sizeof(buffer) - 1)) > 0) {
+        while (length > 0 && buffer[length - 1] == '\n') --length;
+        buffer[length] = '\0';
+        if (!log.empty()) log += "; ";
+        log += buffer;
+    }
+    return log;
+}
+
+bool fail(NativeMount::Error& error, NativeMount::Phase phase, int code, int fs_fd = -1) {
+    error.phase = phase;
+    error.code = code;
+    if (fs_fd >= 0) error.detail = readContextLog(fs_fd);
+    return false;
+}
+
+}
+
+namespace {
+
+std::string_view written(char* buffer, size_t size, int length) {
+    if (length < 0 || size == 0) return std::string_view();
+    return std::string_view(buffer, std::min(static_cast<size_t>(length), size - 1));
+}
+
+}
+
+std::string_view NativeMount::Error::describe(char* buffer, size_t size) const {
+    int length = snprintf(buffer, size, "%s%s%s%s: %s%s%s%s", phaseName(phase),
+                          parameter.empty() ? "" : "(", parameter.c_str(), parameter.empty() ? "" : ")",
+                          strerror(code),
+                          detail.empty() ? "" : " [", detail.c_str(), detail.empty() ? "" : "]");
+    return written(buffer, size, length);
+}
+
+std::string_view NativeMount::Timing::describe(char* buffer, size_t size) const {
+    int length;
+    if (unmount_ms > 0.0) {
+        length = snprintf(buffer, size, "umount2 %.2f ms", unmount_ms);
+    } else {
+        length = snprintf(buffer, size, "open %.2f ms, configure %.2f ms, create %.2f ms, fsmount %.2f ms, move_mount %.2f ms",
+                          open_ms, configure_ms, create_ms, mount_ms, attach_ms);
+    }
+    return written(buffer, size, length);
+}
+
+bool NativeMount::mount(const std::string& fstype, const std::string& source, const std::string& options,
+                        const std::string& target, Timing& timing, Error& error) {
+    timing = Timing();
+    error = Error();
+    auto started = Clock::now();
+    int mount_fd;
+
+    if (fstype == "bind") {
+        mount_fd = sysOpenTree(AT_FDCWD, source.c_str(), OPEN_TREE_CLONE | OPEN_TREE_CLOEXEC);
+        timing.open_ms = since(started);
+        if (mount_fd < 0) return fail(error, Phase::Open, errno);
+    } else {
+        int fs_fd = sysFsopen(fstype.c_str(), FSOPEN_CLOEXEC);
+        timing.open_ms = since(started);
+        if (fs_fd < 0) return fail(error, Phase::Open, errno);
+
+        if (!source.empty() &&
+            sysFsconfig(fs_fd, FSCONFIG_SET_STRING, "source", source.c_str(), 0) != 0) {
+            error.parameter = "source";
+            int code = errno;
+            fail(error, Phase::Configure, code, fs_fd);
+            close(fs_fd);
+            return false;
+        }
+
+        std::stringstream ss(options);
+        std::string option;
+        while (std::getline(ss, option, ',')) {
+            if (option.empty()) continue;
+            size_t equals = option.find('=');
+            int result;
+            if (equals == std::string::npos) {
+                result = sysFsconfig(fs_fd, FSCONFIG_SET_FLAG, option.c_str(), nullptr, 0);
+            } else {
+                std::string key = option.substr(0, equals);
+                std::string value = option.substr(equals + 1);
+                result = sysFsconfig(fs_fd, FSCONFIG_SET_STRING, key.c_str(), value.c_str(), 0);
+            }
+            if (result != 0) {
+                // Never echo values, they may be passwords
+                error.parameter = option.substr(0, equals);
+                int code = errno;
+                fail(error, Phase::Configure, code, fs_fd);
+                close(fs_fd);
+                return false;
+            }
+        }
+        timing.configure_ms = since(started);
+
+        // This is where network filesystems talk to the server
+        if (sysFsconfig(fs_fd, FSCONFIG_CMD_CREATE, nullptr, nullptr, 0) != 0) {
+            int code = errno;
+            timing.create_ms = since(started);
+            fail(error, Phase::Create, code, fs_fd);
+            close(fs_fd);
+            return false;
+        }
+        timing.create_ms = since(started);
+
+        mount_fd = sysFsmount(fs_fd, FSMOUNT_CLOEXEC, 0);
+        timing.mount_ms = since(started);
+        if (mount_fd < 0) {
+            int code = errno;
+            fail(error, Phase::Mount, code, fs_fd);
+            close(fs_fd);
+            return false;
+        }
+        close(fs_fd);
+    }
+
+    int result = sysMoveMount(mount_fd, "", AT_FDCWD, target.c_str(), MOVE_MOUNT_F_EMPTY_PATH);
+    int code = errno;
+    timing.attach_ms = since(started);
+    // Closing a detached mount that was never attached releases it
+    close(mount_fd);
+    if (result != 0) return fail(error, Phase::Attach, code);
+    return true;
+}
+
+bool NativeMount::unmount(const std::string& target, const std::string& flags, Timing& timing, Error& error) {
+    timing = Timing();
+    error = Error();
+
+    int umount_flags = UMOUNT_NOFOLLOW;
+    std::stringstream ss(flags);
+    std::string flag;
+    while (std::getline(ss, flag, ',')) {
+        if (flag == "detach") {
+            umount_flags |= MNT_DETACH;
+        } else if (flag == "force") {
+            umount_flags |= MNT_FORCE;
+        } else if (!flag.empty()) {
+            error.parameter = flag;
+            return fail(error, Phase::Unmount, EINVAL);
+        }
+    }
+
+    auto started = Clock::now();
+    int result = umount2(target.c_str(), umount_flags);
+    int code = errno;
+    timing.unmount_ms = since(started);
+    if (result != 0) return fail(error, Phase::Unmount, code);
+    return true;
+}
+
+const char* NativeMount::phaseName(Phase phase) {
+    switch (phase) {
+        case Phase::None:      return "none";
+        case Phase::Open:      return "fsopen";
+        case Phase::Configure: return "fsconfig";
+        case Phase::Create:    return "fsconfig(create)";
+        case Phase::Mount:     return "fsmount";
+        case Phase::Attach:    return "move_mount";
+        case Phase::Unmount:   return "umount2";
+    }
+    return "unknown";
+}
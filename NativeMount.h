@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// In-process mounting through the new mount API (fsopen/fsconfig/fsmount/
+// move_mount) and umount2(), instead of spawning mount(8)/umount(8).
+// Requires CAP_SYS_ADMIN in the mount namespace owning the target.
+class NativeMount {
+public:
+    enum class Phase { None, Open, Configure, Create, Mount, Attach, Unmount };
+
+    struct Error {
+        Phase phase = Phase::None;
+        int code = 0;           // errno
+        std::string parameter;  // fsconfig key that was rejected, if any
+        std::string detail;     // messages from the filesystem context log
+
+        // Formats into buffer, so it can be passed to a filtered log call for free
+        std::string_view describe(char* buffer, size_t size) const;
+    };
+
+    // Milliseconds spent in each phase
+    struct Timing {
+        double open_ms = 0.0;
+        double configure_ms = 0.0;
+        double create_ms = 0.0;
+        double mount_ms = 0.0;
+        double attach_ms = 0.0;
+        double unmount_ms = 0.0;
+
+        double total() const { return open_ms + configure_ms + create_ms + mount_ms + attach_ms + unmount_ms; }
+        std::string_view describe(char* buffer, size_t size) const;
+    };
+
+    // fstype "bind" clones the source tree (open_tree) instead of creating a
+    // superblock. options are passed to the kernel as-is: "key=value" pairs
+    // become string parameters and bare words flags; helper-only options
+    // such as mount.cifs' credentials= are not understood by the kernel.
+    static bool mount(const std::string& fstype, const std::string& source, const std::string& options,
+                      const std::string& target, Timing& timing, Error& error);
+
+    // flags: comma-separated "detach" and/or "force", empty for a plain unmount
+    static bool unmount(const std::string& target, const std::string& flags, Timing& timing, Error& error);
+
+    static const char* phaseName(Phase phase);
+};
@@ -0,0 +1,205 @@
+#include "ProbeRunner.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// True while a member of the group can still run; zombies do not count, an
+// init that never reaps them must not leave the group stuck forever
+bool groupAlive(pid_t pgid) {
+    if (kill(-pgid, 0) != 0 && errno == ESRCH) return false;
+
+    DIR* proc = opendir("/proc");
+    if (!proc) return true;
+    bool alive = false;
+    while (struct dirent* entry = readdir(proc)) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "/proc/%s/stat", entry->d_name);
+        FILE* file = fopen(path, "re");
+        if (!file) continue;
+        char line[512];
+        bool read = fgets(line, sizeof(line), file) != nullptr;
+        fclose(file);
+        // "pid (comm) state ppid pgrp ...", comm may contain spaces and parens
+        const char* rest = read ? strrchr(line, ')') : nullptr;
+        char state;
+        int ppid, pgrp;
+        if (rest && sscanf(rest + 1, " %c %d %d", &state, &ppid, &pgrp) == 3 &&
+            pgrp == pgid && state != 'Z') {
+            alive = true;
+            break;
+        }
+    }
+    closedir(proc);
+    return alive;
+}
+
+}
+
+ProbeRunner::~ProbeRunner() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reapStuck();
+}
+
+ProbeRunner::Result ProbeRunner::run(const std::function<int()>& probe, int timeout_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Result result;
+    auto started = std::chrono::steady_clock::now();
+    auto elapsed = [&started]() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started).count();
+    };
+
+    reapStuck();
+    if (stuck_.size() >= max_stuck_) {
+        // Earlier helpers are still wedged on the same share, another one would be too
+        result.outcome = Outcome::Saturated;
+        return result;
+    }
+
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return result;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return result;
+    }
+
+    if (pid == 0) {
+        setpgid(0, 0);
+        close(fds[0]);
+        int value = probe();
+        ssize_t written = write(fds[1], &value, sizeof(value));
+        _exit(written == sizeof(value) ? 0 : 1);
+    }
+
+    setpgid(pid, pid);
+    close(fds[1]);
+
+    struct pollfd pfd = {fds[0], POLLIN, 0};
+    int ready;
+    do {
+        int remaining = timeout_ms - static_cast<int>(elapsed());
+        ready = poll(&pfd, 1, std::max(remaining, 0));
+    } while (ready < 0 && errno == EINTR);
+
+    int value = 0;
+    if (ready > 0 && read(fds[0], &value, sizeof(value)) == sizeof(value)) {
+        result.outcome = Outcome::Ok;
+        result.value = value;
+        // The helper exits right after writing
+        waitpid(pid, nullptr, 0);
+    } else {
+        result.outcome = ready == 0 ? Outcome::TimedOut : Outcome::Failed;
+        abandon(pid);
+    }
+    close(fds[0]);
+
+    result.elapsed_ms = elapsed();
+    return result;
+}
+
+size_t ProbeRunner::stuckCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reapStuck();
+    return stuck_.size();
+}
+
+int ProbeRunner::isMountPoint(const std::string& path) {
+    // Same test as mountpoint(1): a different device than the parent, or
+    // the same inode as the parent (the root directory)
+    // (no allocation here: this runs in a forked child)
+    char parent_path[PATH_MAX];
+    if (snprintf(parent_path, sizeof(parent_path), "%s/..", path.c_str()) >= (int)sizeof(parent_path)) {
+        return -ENAMETOOLONG;
+    }
+
+    struct stat self, parent;
+    if (stat(path.c_str(), &self) != 0) return -errno;
+    if (stat(parent_path, &parent) != 0) return -errno;
+    return (self.st_dev != parent.st_dev || self.st_ino == parent.st_ino) ? 1 : 0;
+}
+
+ProbeRunner::Result ProbeRunner::runCommand(const std::string& command, int timeout_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Result result;
+    auto started = std::chrono::steady_clock::now();
+    auto elapsed = [&started]() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started).count();
+    };
+
+    reapStuck();
+    if (stuck_.size() >= max_stuck_) {
+        result.outcome = Outcome::Saturated;
+        return result;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        return result;
+    }
+    if (pid == 0) {
+        // The command itself is the helper, so a hung umount is what gets
+        // killed and tracked, not a shell waiting for it
+        setpgid(0, 0);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    setpgid(pid, pid);
+
+    // No pipe to poll: the command's exit is the only signal
+    while (true) {
+        int status;
+        pid_t reaped = waitpid(pid, &status, WNOHANG);
+        if (reaped == pid) {
+            result.outcome = Outcome::Ok;
+            result.value = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            break;
+        }
+        if (reaped < 0 && errno != EINTR) {
+            break;
+        }
+        if (elapsed() >= timeout_ms) {
+            result.outcome = Outcome::TimedOut;
+            abandon(pid);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    result.elapsed_ms = elapsed();
+    return result;
+}
+
+void ProbeRunner::reapStuck() {
+    stuck_.erase(std::remove_if(stuck_.begin(), stuck_.end(), [](pid_t pid) {
+        waitpid(pid, nullptr, WNOHANG);
+        // Anything the helper started (sudo, umount) keeps the group alive
+        return !groupAlive(pid);
+    }), stuck_.end());
+}
+
+void ProbeRunner::abandon(pid_t pid) {
+    kill(-pid, SIGKILL);
+    kill(pid, SIGKILL);     // in case setpgid lost a race with exec
+    waitpid(pid, nullptr, WNOHANG);
+    stuck_.push_back(pid);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <sys/types.h>
+
+// Runs filesystem probes in a short-lived helper process with a hard
+// deadline. A probe stuck in uninterruptible sleep on a dead network
+// share only blocks the helper, never the caller; the helper is killed
+// and reaped later once the kernel lets it go. Each helper leads its own
+// process group and counts as stuck until the whole group is gone.
+class ProbeRunner {
+public:
+    enum class Outcome {
+        Ok,         // probe finished, value is valid
+        Failed,     // could not start the helper
+        TimedOut,   // deadline passed, helper abandoned
+        Saturated   // too many helpers still stuck, probe not attempted
+    };
+
+    struct Result {
+        Outcome outcome = Outcome::Failed;
+        int value = 0;
+        long elapsed_ms = 0;
+    };
+
+    explicit ProbeRunner(size_t max_stuck = 4) : max_stuck_(max_stuck) {}
+    ~ProbeRunner();
+
+    // The probe runs in a forked child and must only make plain syscalls.
+    Result run(const std::function<int()>& probe, int timeout_ms);
+
+    // Runs "sh -c command" as the helper; value is its exit status
+    Result runCommand(const std::string& command, int timeout_ms);
+
+    // Helpers killed on timeout that have not exited yet
+    size_t stuckCount();
+
+    // Probe: 1 if path is a mount point, 0 if not, -errno on error
+    static int isMountPoint(const std::string& path);
+
+private:
+    size_t max_stuck_;
+    std::vector<pid_t> stuck_;
+    std::mutex mutex_;
+
+    void reapStuck();
+    void abandon(pid_t pid);
+};
@@ -0,0 +1,145 @@
+#include "ReconnectPolicy.h"
+#include <algorithm>
+#include <cmath>
+
+ReconnectPolicy::ReconnectPolicy() : random_(std::random_device{}()) {
+}
+
+void ReconnectPolicy::setOptions(const Options& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+}
+
+bool ReconnectPolicy::connected(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool in_outage = state_ == State::Retrying || state_ == State::CircuitOpen;
+    if (state_ != State::Suspended) state_ = State::Connected;
+    failures_ = 0;
+    attempting_ = false;
+    change_pending_ = false;
+    if (!in_outage) return false;
+
+    stats_.recoveries++;
+    stats_.last_recovery_s = std::chrono::duration<double>(now - outage_started_).count();
+    stats_.last_outage_attempts = stats_.attempts;
+    recovery_sum_s_ += stats_.last_recovery_s;
+    attempt_sum_ += stats_.attempts;
+    stats_.mean_time_to_recovery_s = recovery_sum_s_ / stats_.recoveries;
+    stats_.mean_attempts_per_outage = static_cast<double>(attempt_sum_) / stats_.recoveries;
+    stats_.attempts = 0;
+    return true;
+}
+
+void ReconnectPolicy::disconnected(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Only a drop of an established tunnel is an outage, not a failed first connect
+    if (state_ != State::Connected) return;
+
+    state_ = State::Retrying;
+    stats_.outages++;
+    stats_.attempts = 0;
+    failures_ = 0;
+    outage_started_ = now;
+    next_attempt_ = now;    // the first retry is immediate
+}
+
+bool ReconnectPolicy::attemptDue(Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (state_ == State::Retrying || state_ == State::CircuitOpen) && now >= next_attempt_;
+}
+
+void ReconnectPolicy::attemptStarted(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.attempts++;
+    attempting_ = true;
+    // Keeps a slow attempt from being started again meanwhile
+    next_attempt_ = now + std::chrono::milliseconds(options_.max_delay_ms);
+}
+
+void ReconnectPolicy::attemptFailed(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != State::Retrying && state_ != State::CircuitOpen) return;
+    attempting_ = false;
+
+    if (change_pending_) {
+        // The uplink changed under the failed attempt; try the new path right away
+        change_pending_ = false;
+        state_ = State::Retrying;
+        failures_ = 0;
+        next_attempt_ = now;
+        return;
+    }
+
+    failures_++;
+    if (options_.breaker_threshold > 0 && failures_ >= static_cast<unsigned>(options_.breaker_threshold)) {
+        if (state_ != State::CircuitOpen) stats_.breaker_trips++;
+        state_ = State::CircuitOpen;
+        next_attempt_ = now + std::chrono::milliseconds(options_.breaker_cooldown_ms);
+    } else {
+        next_attempt_ = now + backoff();
+    }
+}
+
+void ReconnectPolicy::networkChanged(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != State::Retrying && state_ != State::CircuitOpen) return;
+
+    if (attempting_) {
+        change_pending_ = true;
+        return;
+    }
+
+    // A new path invalidates what the failures said about the old one
+    state_ = State::Retrying;
+    failures_ = 0;
+    next_attempt_ = now;
+}
+
+void ReconnectPolicy::suspend() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_ = State::Suspended;
+    stats_.attempts = 0;
+    attempting_ = false;
+    change_pending_ = false;
+}
+
+void ReconnectPolicy::resume() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == State::Suspended) state_ = State::Idle;
+}
+
+ReconnectPolicy::State ReconnectPolicy::state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+ReconnectPolicy::Clock::time_point ReconnectPolicy::nextAttempt() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_attempt_;
+}
+
+ReconnectPolicy::Stats ReconnectPolicy::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+const char* ReconnectPolicy::stateName(State state) {
+    switch (state) {
+        case State::Idle:        return "idle";
+        case State::Connected:   return "connected";
+        case State::Retrying:    return "retrying";
+        case State::CircuitOpen: return "circuit open";
+        case State::Suspended:   return "suspended";
+    }
+    return "unknown";
+}
+
+ReconnectPolicy::Clock::duration ReconnectPolicy::backoff() {
+    double delay = options_.base_delay_ms * std::pow(options_.multiplier, static_cast<double>(failures_ - 1));
+    delay = std::min(delay, static_cast<double>(options_.max_delay_ms));
+    if (options_.jitter > 0.0) {
+        std::uniform_real_distribution<double> spread(1.0 - options_.jitter, 1.0 + options_.jitter);
+        delay *= spread(random_);
+    }
+    return std::chrono::milliseconds(static_cast<long long>(std::max(delay, 0.0)));
+}
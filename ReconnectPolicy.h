@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <random>
+
+// Decides when to try reconnecting a dropped tunnel: an immediate first
+// retry, then exponential backoff with jitter, and a circuit breaker that
+// stops hammering after repeated failures. A change of the underlying
+// uplink makes the next attempt due at once. Also tracks time to recovery.
+class ReconnectPolicy {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        int base_delay_ms = 2000;           // delay after the first failed retry
+        int max_delay_ms = 300000;
+        double multiplier = 2.0;
+        double jitter = 0.2;                // +-20% of each delay
+        int breaker_threshold = 8;          // consecutive failures that open the circuit
+        int breaker_cooldown_ms = 600000;   // then one probe attempt per cooldown
+    };
+
+    enum class State { Idle, Connected, Retrying, CircuitOpen, Suspended };
+
+    struct Stats {
+        unsigned outages = 0;
+        unsigned recoveries = 0;
+        unsigned breaker_trips = 0;
+        unsigned attempts = 0;              // in the current outage
+        unsigned last_outage_attempts = 0;
+        double last_recovery_s = 0.0;
+        double mean_time_to_recovery_s = 0.0;
+        double mean_attempts_per_outage = 0.0;
+    };
+
+    ReconnectPolicy();
+
+    void setOptions(const Options& options);
+
+    // Status observations; connected() returns true when it ends an outage.
+    // Only a drop after connected() starts an outage.
+    bool connected(Clock::time_point now = Clock::now());
+    void disconnected(Clock::time_point now = Clock::now());
+
+    bool attemptDue(Clock::time_point now = Clock::now()) const;
+    void attemptStarted(Clock::time_point now = Clock::now());
+    void attemptFailed(Clock::time_point now = Clock::now());
+
+    // New default route or interface up: retry now, even if the circuit is open
+    void networkChanged(Clock::time_point now = Clock::now());
+
+    // The user disconnected on purpose; no retries until resume()
+    void suspend();
+    void resume();
+
+    State state() const;
+    Clock::time_point nextAttempt() const;
+    Stats stats() const;
+
+    static const char* stateName(State state);
+
+private:
+    Options options_;
+    State state_ = State::Idle;
+    Clock::time_point outage_started_;
+    Clock::time_point next_attempt_;
+    unsigned failures_ = 0;             // consecutive, drives the backoff
+    bool attempting_ = false;
+    bool change_pending_ = false;       // uplink changed during an attempt
+    Stats stats_;
+    double recovery_sum_s_ = 0.0;
+    unsigned long attempt_sum_ = 0;
+    std::mt19937 random_;
+    mutable std::mutex mutex_;
+
+    Clock::duration backoff();
+};
@@ -0,0 +1,323 @@
+#include "RtNetlink.h"
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+struct Request {
+    struct nlmsghdr header;
+    union {
+        struct ifinfomsg link;
+        struct ifaddrmsg addr;
+        struct rtmsg route;
+    };
+    char attributes[256];
+};
+
+// IFLA_IFNAME of a link message, empty if missing
+std::string linkName(struct nlmsghdr* message) {
+    auto* link = static_cast<struct ifinfomsg*>(NLMSG_DATA(message));
+    int remaining = IFLA_PAYLOAD(message);
+    for (auto* attribute = IFLA_RTA(link); RTA_OK(attribute, remaining);
+         attribute = RTA_NEXT(attribute, remaining)) {
+        if (attribute->rta_type == IFLA_IFNAME) {
+            return std::string(static_cast<const char*>(RTA_DATA(attribute)),
+                               strnlen(static_cast<const char*>(RTA_DATA(attribute)), RTA_PAYLOAD(attribute)));
+        }
+    }
+    return "";
+}
+
+void addAttribute(Request& request, unsigned short type, const void* data, size_t length) {
+    char* base = reinterpret_cast<char*>(&request);
+    auto* attribute = reinterpret_cast<struct rtattr*>(base + NLMSG_ALIGN(request.header.nlmsg_len));
+    attribute->rta_type = type;
+    attribute->rta_len = RTA_LENGTH(length);
+    memcpy(RTA_DATA(attribute), data, length);
+    request.header.nlmsg_len = NLMSG_ALIGN(request.header.nlmsg_len) + RTA_ALIGN(attribute->rta_len);
+}
+
+}
+
+RtNetlink::~RtNetlink() {
+    if (fd_ >= 0) close(fd_);
+}
+
+bool RtNetlink::setLinkUp(const std::string& ifname, bool up) {
+    std::string what = std::string(up ? "link up " : "link down ") + ifname;
+    int index = linkIndex(ifname, what);
+    if (index <= 0) return false;
+
+    Request request = {};
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    request.header.nlmsg_type = RTM_NEWLINK;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    request.link.ifi_family = AF_UNSPEC;
+    request.link.ifi_index = index;
+    request.link.ifi_flags = up ? IFF_UP : 0;
+    request.link.ifi_change = IFF_UP;
+    return transact(&request, what);
+}
+
+bool RtNetlink::addAddress(const std::string& ifname, const std::string& cidr) {
+    return changeAddress(ifname, cidr, true);
+}
+
+bool RtNetlink::deleteAddress(const std::string& ifname, const std::string& cidr) {
+    return changeAddress(ifname, cidr, false);
+}
+
+bool RtNetlink::addRoute(const std::string& cidr, const std::string& ifname) {
+    std::string what = "route " + cidr + " dev " + ifname;
+    Prefix prefix;
+    if (cidr == "default") {
+        prefix.family = AF_INET;
+    } else if (!parsePrefix(cidr, prefix)) {
+        return fail(what, EINVAL);
+    }
+    int index = linkIndex(ifname, what);
+    if (index <= 0) return false;
+
+    Request request = {};
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+    request.header.nlmsg_type = RTM_NEWROUTE;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | NLM_F_CREATE | NLM_F_REPLACE;
+    request.route.rtm_family = prefix.family;
+    request.route.rtm_dst_len = prefix.length;
+    request.route.rtm_table = RT_TABLE_MAIN;
+    request.route.rtm_protocol = RTPROT_BOOT;
+    request.route.rtm_scope = RT_SCOPE_LINK;
+    request.route.rtm_type = RTN_UNICAST;
+    if (prefix.length > 0) {
+        addAttribute(request, RTA_DST, prefix.bytes, prefix.family == AF_INET ? 4 : 16);
+    }
+    addAttribute(request, RTA_OIF, &index, sizeof(index));
+    return transact(&request, what);
+}
+
+bool RtNetlink::ensureOpen() {
+    if (fd_ >= 0) return true;
+
+    fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd_ < 0) return fail("netlink socket", errno);
+
+    struct sockaddr_nl local = {};
+    local.nl_family = AF_NETLINK;
+    if (bind(fd_, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) != 0) {
+        int error = errno;
+        close(fd_);
+        fd_ = -1;
+        return fail("netlink bind", error);
+    }
+    return true;
+}
+
+bool RtNetlink::transact(void* request, const std::string& what) {
+    if (!ensureOpen()) return false;
+
+    auto* header = static_cast<struct nlmsghdr*>(request);
+    header->nlmsg_seq = ++seq_;
+
+    struct sockaddr_nl kernel = {};
+    kernel.nl_family = AF_NETLINK;
+    if (sendto(fd_, header, header->nlmsg_len, 0,
+               reinterpret_cast<struct sockaddr*>(&kernel), sizeof(kernel)) < 0) {
+        return fail(what, errno);
+    }
+
+    // The ACK is an NLMSG_ERROR with error 0; skip anything from earlier requests
+    char buffer[4096];
+    while (true) {
+        ssize_t length = recv(fd_, buffer, sizeof(buffer), 0);
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            return fail(what, errno);
+        }
+        for (auto* reply = reinterpret_cast<struct nlmsghdr*>(buffer);
+             NLMSG_OK(reply, static_cast<unsigned int>(length));
+             reply = NLMSG_NEXT(reply, length)) {
+            if (reply->nlmsg_seq != seq_ || reply->nlmsg_type != NLMSG_ERROR) continue;
+            auto* error = static_cast<struct nlmsgerr*>(NLMSG_DATA(reply));
+            if (error->error == 0) {
+                last_error_.clear();
+                last_errno_ = 0;
+                return true;
+            }
+            return fail(what, -error->error);
+        }
+    }
+}
+
+bool RtNetlink::fail(const std::string& what, int error) {
+    last_errno_ = error;
+    last_error_ = what + ": " + strerror(error);
+    return false;
+}
+
+int RtNetlink::linkIndex(const std::string& ifname, const std::string& what) {
+    unsigned int index = if_nametoindex(ifname.c_str());
+    if (index == 0) fail(what, errno);
+    return static_cast<int>(index);
+}
+
+bool RtNetlink::changeAddress(const std::string& ifname, const std::string& cidr, bool add) {
+    std::string what = std::string(add ? "add address " : "delete address ") + cidr + " dev " + ifname;
+    Prefix prefix;
+    if (!parsePrefix(cidr, prefix)) return fail(what, EINVAL);
+    int index = linkIndex(ifname, what);
+    if (index <= 0) return false;
+
+    Request request = {};
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifaddrmsg));
+    request.header.nlmsg_type = add ? RTM_NEWADDR : RTM_DELADDR;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | (add ? NLM_F_CREATE | NLM_F_REPLACE : 0);
+    request.addr.ifa_family = prefix.family;
+    request.addr.ifa_prefixlen = prefix.length;
+    request.addr.ifa_scope = RT_SCOPE_UNIVERSE;
+    request.addr.ifa_index = index;
+    size_t length = prefix.family == AF_INET ? 4 : 16;
+    addAttribute(request, IFA_LOCAL, prefix.bytes, length);
+    addAttribute(request, IFA_ADDRESS, prefix.bytes, length);
+
+    if (transact(&request, what)) return true;
+    // Removing an address that is already gone is fine
+    return !add && last_errno_ == EADDRNOTAVAIL;
+}
+
+bool RtNetlink::parsePrefix(const std::string& cidr, Prefix& prefix) {
+    size_t slash = cidr.find('/');
+    std::string address = cidr.substr(0, slash);
+
+    if (inet_pton(AF_INET, address.c_str(), prefix.bytes) == 1) {
+        prefix.family = AF_INET;
+        prefix.length = 32;
+    } else if (inet_pton(AF_INET6, address.c_str(), prefix.bytes) == 1) {
+        prefix.family = AF_INET6;
+        prefix.length = 128;
+    } else {
+        return false;
+    }
+
+    if (slash != std::string::npos) {
+        int max_length = prefix.length;
+        try {
+            prefix.length = std::stoi(cidr.substr(slash + 1));
+        } catch (...) {
+            return false;
+        }
+        if (prefix.length < 0 || prefix.length > max_length) return false;
+    }
+    return true;
+}
+
+UplinkMonitor::~UplinkMonitor() {
+    close();
+}
+
+bool UplinkMonitor::open(const std::string& ignore_ifname) {
+    close();
+    ignore_ = ignore_ifname;
+    // Later renames, deletions and re-creations arrive as link messages
+    if (unsigned int index = ignore_.empty() ? 0 : if_nametoindex(ignore_.c_str())) {
+        tunnel_.insert(static_cast<int>(index));
+    }
+
+    fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+    if (fd_ < 0) {
+        last_error_ = std::string("netlink socket: ") + strerror(errno);
+        return false;
+    }
+
+    struct sockaddr_nl local = {};
+    local.nl_family = AF_NETLINK;
+    local.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+    if (bind(fd_, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) != 0) {
+        last_error_ = std::string("netlink bind: ") + strerror(errno);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void UplinkMonitor::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    running_.clear();
+    tunnel_.clear();
+}
+
+bool UplinkMonitor::wait(int timeout_ms, std::string& change) {
+    if (fd_ < 0) return false;
+
+    struct pollfd pfd = {fd_, POLLIN, 0};
+    if (poll(&pfd, 1, timeout_ms) <= 0) return false;
+
+    // Drain everything queued; a burst of notifications is one change
+    bool changed = false;
+    char buffer[8192];
+    while (true) {
+        ssize_t length = recv(fd_, buffer, sizeof(buffer), 0);
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ENOBUFS) {
+                // Notifications were dropped, so assume we missed something
+                change = "netlink notifications lost";
+                changed = true;
+                continue;
+            }
+            break;
+        }
+
+        for (auto* message = reinterpret_cast<struct nlmsghdr*>(buffer);
+             NLMSG_OK(message, static_cast<unsigned int>(length));
+             message = NLMSG_NEXT(message, length)) {
+            if (message->nlmsg_type == RTM_NEWLINK || message->nlmsg_type == RTM_DELLINK) {
+                auto* link = static_cast<struct ifinfomsg*>(NLMSG_DATA(message));
+                if (message->nlmsg_type == RTM_DELLINK) {
+                    running_.erase(link->ifi_index);
+                    tunnel_.erase(link->ifi_index);
+                    continue;
+                }
+                // Taken from the message: by now the index may name another link
+                std::string name = linkName(message);
+                if (!ignore_.empty() && name == ignore_) {
+                    tunnel_.insert(link->ifi_index);
+                    continue;
+                }
+                tunnel_.erase(link->ifi_index);
+                bool running = (link->ifi_flags & (IFF_UP | IFF_RUNNING)) == (IFF_UP | IFF_RUNNING);
+                auto known = running_.find(link->ifi_index);
+                if (running && (known == running_.end() || !known->second)) {
+                    change = "link " + (name.empty() ? std::string("?") : name) + " up";
+                    changed = true;
+                }
+                running_[link->ifi_index] = running;
+            } else if (message->nlmsg_type == RTM_NEWROUTE) {
+                auto* route = static_cast<struct rtmsg*>(NLMSG_DATA(message));
+                if (route->rtm_dst_len != 0 || route->rtm_type != RTN_UNICAST) continue;
+                if (route->rtm_table != RT_TABLE_MAIN && route->rtm_table != RT_TABLE_UNSPEC) continue;
+
+                int oif = 0;
+                int remaining = RTM_PAYLOAD(message);
+                for (auto* attribute = RTM_RTA(route); RTA_OK(attribute, remaining);
+                     attribute = RTA_NEXT(attribute, remaining)) {
+                    if (attribute->rta_type == RTA_OIF) memcpy(&oif, RTA_DATA(attribute), sizeof(oif));
+                }
+                if (tunnel_.count(oif)) continue;
+
+                char name[IF_NAMESIZE] = "?";
+                if (oif > 0) if_indextoname(oif, name);
+                change = std::string("new default route via ") + name;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
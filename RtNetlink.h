@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Minimal rtnetlink client for an existing tunnel interface: link up/down,
+// addresses and device routes, without forking ip(8) or wg-quick.
+// Needs CAP_NET_ADMIN in the interface's network namespace.
+class RtNetlink {
+public:
+    RtNetlink() = default;
+    ~RtNetlink();
+
+    RtNetlink(const RtNetlink&) = delete;
+    RtNetlink& operator=(const RtNetlink&) = delete;
+
+    bool setLinkUp(const std::string& ifname, bool up);
+    // cidr is "10.0.0.2/24" or "fd00::2/64"; existing addresses are not an error
+    bool addAddress(const std::string& ifname, const std::string& cidr);
+    bool deleteAddress(const std::string& ifname, const std::string& cidr);
+    // Device route through ifname; cidr may be "default"
+    bool addRoute(const std::string& cidr, const std::string& ifname);
+
+    // Description of the last failure, e.g. "add address 10.0.0.2/24 dev wg0: Operation not permitted"
+    const std::string& lastError() const { return last_error_; }
+    int lastErrno() const { return last_errno_; }
+
+private:
+    int fd_ = -1;
+    unsigned int seq_ = 0;
+    std::string last_error_;
+    int last_errno_ = 0;
+
+    bool ensureOpen();
+    bool transact(void* request, const std::string& what);
+    bool fail(const std::string& what, int error);
+    int linkIndex(const std::string& ifname, const std::string& what);
+    bool changeAddress(const std::string& ifname, const std::string& cidr, bool add);
+
+    struct Prefix {
+        int family = 0;
+        unsigned char bytes[16] = {};
+        int length = 0;
+    };
+    static bool parsePrefix(const std::string& cidr, Prefix& prefix);
+};
+
+// Listens to rtnetlink notifications for signs that the uplink changed: an
+// interface coming up or a new default route. Events on ignore_ifname, the
+// tunnel itself, are skipped; the tunnel is recognised by the name in each
+// link message, so a tunnel recreated under a new index is skipped too.
+// Needs no privileges.
+class UplinkMonitor {
+public:
+    UplinkMonitor() = default;
+    ~UplinkMonitor();
+
+    UplinkMonitor(const UplinkMonitor&) = delete;
+    UplinkMonitor& operator=(const UplinkMonitor&) = delete;
+
+    bool open(const std::string& ignore_ifname = "");
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Waits up to timeout_ms; true if a change was seen, described in change
+    bool wait(int timeout_ms, std::string& change);
+
+    const std::string& lastError() const { return last_error_; }
+
+private:
+    int fd_ = -1;
+    std::string ignore_;
+    std::string last_error_;
+    std::unordered_map<int, bool> running_;    // link index -> last seen IFF_RUNNING
+    std::unordered_set<int> tunnel_;            // link indexes currently named ignore_
+};
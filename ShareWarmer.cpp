@@ -0,0 +1,175 @@
+#include "ShareWarmer.h"
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct ShareWarmer::Run {
+    Options options;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point deadline;
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<std::pair<std::string, int>> queue; // path, depth
+    int active = 0;
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> finished{false};
+    std::atomic<bool> budget_exhausted{false};
+    std::atomic<long> entries{0};
+    std::atomic<long> directories{0};
+    std::atomic<long> errors{0};
+
+    std::mutex callback_mutex;
+    DoneCallback callback;
+
+    bool shouldStop() {
+        if (cancelled.load()) return true;
+        if (entries.load() >= options.max_entries ||
+            std::chrono::steady_clock::now() >= deadline) {
+            budget_exhausted.store(true);
+            return true;
+        }
+        return false;
+    }
+};
+
+ShareWarmer::~ShareWarmer() {
+    cancel();
+}
+
+void ShareWarmer::start(const std::string& root, const Options& options, DoneCallback callback) {
+    cancel();
+
+    auto run = std::make_shared<Run>();
+    run->options = options;
+    if (run->options.threads < 1) run->options.threads = 1;
+    run->started = std::chrono::steady_clock::now();
+    run->deadline = run->started + std::chrono::milliseconds(options.time_budget_ms);
+    run->callback = std::move(callback);
+
+    for (const auto& dir : options.dirs) {
+        if (dir.empty() || dir == "." || dir == "/") {
+            run->queue.emplace_back(root, 0);
+        } else {
+            run->queue.emplace_back(root + (dir.front() == '/' ? "" : "/") + dir, 0);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        run_ = run;
+    }
+
+    // The coordinator is detached: a worker stuck on an unresponsive share
+    // must never block the caller, and it keeps the run state alive itself.
+    std::thread(&ShareWarmer::coordinate, run).detach();
+}
+
+void ShareWarmer::cancel() {
+    std::shared_ptr<Run> run;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        run.swap(run_);
+    }
+    if (!run) return;
+
+    run->cancelled.store(true);
+    run->queue_cv.notify_all();
+
+    // Waits for a callback already in flight, so the owner may go away after this
+    std::lock_guard<std::mutex> lock(run->callback_mutex);
+    run->callback = nullptr;
+}
+
+bool ShareWarmer::running() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return run_ && !run_->finished.load();
+}
+
+void ShareWarmer::coordinate(std::shared_ptr<Run> run) {
+    std::vector<std::thread> workers;
+    for (int i = 0; i < run->options.threads; ++i) {
+        workers.emplace_back(&ShareWarmer::work, std::ref(*run));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    Result result;
+    result.entries = run->entries.load();
+    result.directories = run->directories.load();
+    result.errors = run->errors.load();
+    result.cancelled = run->cancelled.load();
+    result.budget_exhausted = run->budget_exhausted.load();
+    result.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - run->started).count();
+    run->finished.store(true);
+
+    std::lock_guard<std::mutex> lock(run->callback_mutex);
+    if (run->callback && !result.cancelled) {
+        run->callback(result);
+    }
+}
+
+void ShareWarmer::work(Run& run) {
+    std::vector<std::pair<std::string, int>> children;
+
+    while (true) {
+        std::pair<std::string, int> item;
+        {
+            std::unique_lock<std::mutex> lock(run.queue_mutex);
+            while (run.queue.empty() && run.active > 0 && !run.shouldStop()) {
+                run.queue_cv.wait_for(lock, std::chrono::milliseconds(50));
+            }
+            if (run.queue.empty() || run.shouldStop()) {
+                run.queue_cv.notify_all();
+                return;
+            }
+            item = std::move(run.queue.front());
+            run.queue.pop_front();
+            ++run.active;
+        }
+
+        children.clear();
+        int fd = open(item.first.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        DIR* dir = fd >= 0 ? fdopendir(fd) : nullptr;
+        if (!dir) {
+            if (fd >= 0) close(fd);
+            run.errors++;
+        } else {
+            run.directories++;
+            while (struct dirent* entry = readdir(dir)) {
+                const char* name = entry->d_name;
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+                if (run.shouldStop()) break;
+
+                struct statx stx;
+                run.entries++;
+                if (statx(dirfd(dir), name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT,
+                          STATX_BASIC_STATS, &stx) != 0) {
+                    run.errors++;
+                    continue;
+                }
+                if (S_ISDIR(stx.stx_mode) && item.second < run.options.max_depth) {
+                    children.emplace_back(item.first + "/" + name, item.second + 1);
+                }
+            }
+            closedir(dir);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(run.queue_mutex);
+            for (auto& child : children) {
+                run.queue.push_back(std::move(child));
+            }
+            --run.active;
+        }
+        run.queue_cv.notify_all();
+    }
+}
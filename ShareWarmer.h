@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+// Walks a set of directories on a freshly mounted share with a small pool of
+// worker threads so the kernel's dentry/attribute caches are warm before the
+// user opens anything.
+class ShareWarmer {
+public:
+    struct Options {
+        std::vector<std::string> dirs;  // relative to root; empty entry = root itself
+        int max_depth = 2;
+        int threads = 4;
+        int time_budget_ms = 5000;
+        long max_entries = 20000;       // I/O budget: stat calls issued
+    };
+
+    struct Result {
+        long entries = 0;       // entries stat'ed
+        long directories = 0;   // directories read
+        long errors = 0;
+        long elapsed_ms = 0;
+        bool cancelled = false;
+        bool budget_exhausted = false;
+    };
+
+    using DoneCallback = std::function<void(const Result&)>;
+
+    ShareWarmer() = default;
+    ~ShareWarmer();
+
+    // Starts a warm-up run in the background. A run already in progress is
+    // cancelled first. The callback is invoked from the worker side once
+    // the run ends, unless cancel() was called before that.
+    void start(const std::string& root, const Options& options, DoneCallback callback);
+
+    // Stops the current run. Does not wait for workers blocked in the
+    // filesystem; once this returns the callback will not be invoked.
+    void cancel();
+
+    bool running() const;
+
+private:
+    struct Run;
+    std::shared_ptr<Run> run_;
+    mutable std::mutex mutex_;
+
+    static void coordinate(std::shared_ptr<Run> run);
+    static void work(Run& run);
+};
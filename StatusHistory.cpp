@@ -0,0 +1,165 @@
+#include "StatusHistory.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Gaps longer than this (suspend, monitor stopped) are not counted as uptime or downtime
+const long MAX_ATTRIBUTED_GAP_S = 600;
+
+uint16_t saturate16(long value) {
+    return static_cast<uint16_t>(std::min<long>(std::max<long>(value, 0), UINT16_MAX));
+}
+
+}
+
+template <size_t N>
+void StatusHistory::BucketRing<N>::add(int64_t sample_period, const RawSample& sample) {
+    if (period < 0) {
+        period = sample_period;
+        buckets[head] = Bucket{};
+    } else if (sample_period > period) {
+        int64_t steps = std::min<int64_t>(sample_period - period, N);
+        for (int64_t i = 0; i < steps; ++i) {
+            head = (head + 1) % N;
+            buckets[head] = Bucket{};
+        }
+        period = sample_period;
+    }
+
+    Bucket& bucket = buckets[head];
+    if (bucket.samples == UINT16_MAX) return;
+    bucket.samples++;
+    if (sample.flags & FLAG_CONNECTED) bucket.connected++;
+    if (sample.flags & FLAG_MOUNTED) bucket.mounted++;
+    if (sample.flags & FLAG_ERROR) bucket.errors++;
+    bucket.latency_sum_ms += sample.latency_ms;
+}
+
+void StatusHistory::record(bool connected, bool mounted, long latency_ms, bool error, time_t now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    RawSample sample;
+    sample.delta_s = 0;
+    sample.latency_ms = saturate16(latency_ms);
+    sample.flags = (connected ? FLAG_CONNECTED : 0) | (mounted ? FLAG_MOUNTED : 0) | (error ? FLAG_ERROR : 0);
+
+    if (raw_count_ > 0) {
+        const RawSample& previous = raw_[(raw_head_ + RAW_SAMPLES - 1) % RAW_SAMPLES];
+        bool was_connected = previous.flags & FLAG_CONNECTED;
+        long delta = static_cast<long>(now - last_time_);
+        sample.delta_s = saturate16(delta);
+
+        long attributed = std::min(std::max(delta, 0L), MAX_ATTRIBUTED_GAP_S);
+        total_s_ += attributed;
+        if (was_connected) up_s_ += attributed;
+
+        if (was_connected && !connected) {
+            flaps_++;
+            down_since_ = now;
+        } else if (!was_connected && connected && down_since_ != 0) {
+            reconnects_++;
+            reconnect_sum_s_ += static_cast<long>(now - down_since_);
+            down_since_ = 0;
+        }
+    }
+
+    raw_[raw_head_] = sample;
+    raw_head_ = (raw_head_ + 1) % RAW_SAMPLES;
+    raw_count_ = std::min(raw_count_ + 1, RAW_SAMPLES);
+    last_time_ = now;
+
+    minutes_.add(now / 60, sample);
+    hours_.add(now / 3600, sample);
+}
+
+StatusHistory::Stats StatusHistory::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Stats stats;
+    stats.flaps = flaps_;
+    stats.reconnects = reconnects_;
+    stats.tracked_s = total_s_;
+    if (total_s_ > 0) {
+        stats.uptime_percent = 100.0 * up_s_ / total_s_;
+    } else if (raw_count_ > 0) {
+        bool connected = raw_[(raw_head_ + RAW_SAMPLES - 1) % RAW_SAMPLES].flags & FLAG_CONNECTED;
+        stats.uptime_percent = connected ? 100.0 : 0.0;
+    }
+    if (reconnects_ > 0) {
+        stats.mean_time_to_reconnect_s = static_cast<double>(reconnect_sum_s_) / reconnects_;
+    }
+    return stats;
+}
+
+std::vector<float> StatusHistory::series(Tier tier, Metric metric, size_t count) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<float> values;
+
+    auto collect = [&](const Bucket* buckets, size_t size, size_t head, size_t available) {
+        count = std::min(count, available);
+        values.reserve(count);
+        for (size_t i = count; i > 0; --i) {
+            values.push_back(value(buckets[(head + size + 1 - i) % size], metric));
+        }
+    };
+
+    switch (tier) {
+        case Tier::Raw: {
+            count = std::min(count, raw_count_);
+            values.reserve(count);
+            for (size_t i = count; i > 0; --i) {
+                const RawSample& sample = raw_[(raw_head_ + RAW_SAMPLES - i) % RAW_SAMPLES];
+                Bucket bucket;
+                bucket.samples = 1;
+                bucket.connected = (sample.flags & FLAG_CONNECTED) ? 1 : 0;
+                bucket.mounted = (sample.flags & FLAG_MOUNTED) ? 1 : 0;
+                bucket.errors = (sample.flags & FLAG_ERROR) ? 1 : 0;
+                bucket.latency_sum_ms = sample.latency_ms;
+                values.push_back(value(bucket, metric));
+            }
+            break;
+        }
+        case Tier::Minute:
+            collect(minutes_.buckets, MINUTE_BUCKETS, minutes_.head, minutes_.period < 0 ? 0 : MINUTE_BUCKETS);
+            break;
+        case Tier::Hour:
+            collect(hours_.buckets, HOUR_BUCKETS, hours_.head, hours_.period < 0 ? 0 : HOUR_BUCKETS);
+            break;
+    }
+    return values;
+}
+
+std::string StatusHistory::sparkline(const std::vector<float>& values, float max_value, bool unicode) {
+    static const char* const unicode_glyphs[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    static const char* const ascii_glyphs[] = {"_", ".", "-", "=", "+", "*", "#"};
+    const char* const* glyphs = unicode ? unicode_glyphs : ascii_glyphs;
+    int levels = unicode ? 8 : 7;
+
+    if (max_value <= 0.0f) {
+        for (float v : values) max_value = std::max(max_value, v);
+        if (max_value <= 0.0f) max_value = 1.0f;
+    }
+
+    std::string line;
+    for (float v : values) {
+        if (v < 0.0f) {
+            line += " ";
+            continue;
+        }
+        int level = static_cast<int>(std::lround(std::min(v / max_value, 1.0f) * (levels - 1)));
+        line += glyphs[level];
+    }
+    return line;
+}
+
+float StatusHistory::value(const Bucket& bucket, Metric metric) {
+    if (bucket.samples == 0) return -1.0f;
+    switch (metric) {
+        case Metric::Connected: return static_cast<float>(bucket.connected) / bucket.samples;
+        case Metric::Mounted:   return static_cast<float>(bucket.mounted) / bucket.samples;
+        case Metric::Latency:   return static_cast<float>(bucket.latency_sum_ms) / bucket.samples;
+        case Metric::Errors:    return static_cast<float>(bucket.errors);
+    }
+    return -1.0f;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <mutex>
+
+// Fixed-memory history of status samples. The newest samples are kept
+// delta-encoded at full resolution; older data survives as per-minute
+// (last 24 h) and per-hour (last 30 days) aggregates. Uptime and flap
+// statistics are maintained incrementally.
+class StatusHistory {
+public:
+    enum class Tier { Raw, Minute, Hour };
+    enum class Metric { Connected, Mounted, Latency, Errors };
+
+    struct Stats {
+        double uptime_percent = 0.0;    // time-weighted, since start
+        unsigned flaps = 0;             // connected -> disconnected transitions
+        unsigned reconnects = 0;
+        double mean_time_to_reconnect_s = 0.0;
+        long tracked_s = 0;
+    };
+
+    static constexpr size_t RAW_SAMPLES = 256;
+    static constexpr size_t MINUTE_BUCKETS = 24 * 60;
+    static constexpr size_t HOUR_BUCKETS = 30 * 24;
+
+    void record(bool connected, bool mounted, long latency_ms, bool error, time_t now = std::time(nullptr));
+
+    Stats stats() const;
+
+    // Newest `count` points of a tier, oldest first. Connected/Mounted are
+    // fractions in [0, 1], Latency is the mean in ms, Errors a count.
+    // Slots without samples are returned as -1.
+    std::vector<float> series(Tier tier, Metric metric, size_t count) const;
+
+    // Renders values as a one-line sparkline scaled to max_value
+    // (0 = the largest value); -1 entries are rendered as gaps.
+    static std::string sparkline(const std::vector<float>& values, float max_value, bool unicode);
+
+private:
+    // 6 bytes per raw sample: time is stored relative to the previous one
+    struct RawSample {
+        uint16_t delta_s;
+        uint16_t latency_ms;
+        uint8_t flags;
+    };
+
+    struct Bucket {
+        uint16_t samples = 0;
+        uint16_t connected = 0;
+        uint16_t mounted = 0;
+        uint16_t errors = 0;
+        uint32_t latency_sum_ms = 0;
+    };
+
+    template <size_t N>
+    struct BucketRing {
+        Bucket buckets[N];
+        size_t head = 0;        // index of the current bucket
+        int64_t period = -1;    // period number of the current bucket
+        void add(int64_t sample_period, const RawSample& sample);
+    };
+
+    enum Flags : uint8_t { FLAG_CONNECTED = 1, FLAG_MOUNTED = 2, FLAG_ERROR = 4 };
+
+    RawSample raw_[RAW_SAMPLES] = {};
+    size_t raw_head_ = 0;
+    size_t raw_count_ = 0;
+    time_t last_time_ = 0;
+
+    BucketRing<MINUTE_BUCKETS> minutes_;
+    BucketRing<HOUR_BUCKETS> hours_;
+
+    // Incremental statistics
+    long up_s_ = 0;
+    long total_s_ = 0;
+    unsigned flaps_ = 0;
+    unsigned reconnects_ = 0;
+    long reconnect_sum_s_ = 0;
+    time_t down_since_ = 0;
+
+    mutable std::mutex mutex_;
+
+    static float value(const Bucket& bucket, Metric metric);
+};
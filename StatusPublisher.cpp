@@ -0,0 +1,89 @@
+#include "StatusPublisher.h"
+#include <sys/file.h>
+#include <sys/stat.h>
+
+StatusPublisher::~StatusPublisher() {
+    close();
+}
+
+bool StatusPublisher::open(const std::string& path) {
+    close();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0644);
+    if (fd < 0) {
+        last_error_ = strerror(errno);
+        return false;
+    }
+
+    // Another frontend publishing to the same page would interleave
+    // sequence updates and leave readers spinning on a torn page
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        last_error_ = errno == EWOULDBLOCK ? "in use by another HomeVPN instance" : strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (static_cast<size_t>(st.st_size) < sizeof(homevpn::StatusPage) &&
+                                ftruncate(fd, sizeof(homevpn::StatusPage)) != 0)) {
+        last_error_ = strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(homevpn::StatusPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        last_error_ = strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    lock_fd_ = fd;
+
+    page_ = static_cast<homevpn::StatusPage*>(mapping);
+    if (page_->magic != homevpn::STATUS_PAGE_MAGIC || page_->version != homevpn::STATUS_PAGE_VERSION ||
+        page_->size != sizeof(homevpn::StatusPage)) {
+        // New file or an older layout: start over, keeping the sequence
+        // moving forward so mapped readers still notice the change
+        uint32_t sequence = (page_->sequence + 2) & ~1u;
+        memset(page_, 0, sizeof(homevpn::StatusPage));
+        page_->sequence = sequence;
+        page_->size = sizeof(homevpn::StatusPage);
+        page_->version = homevpn::STATUS_PAGE_VERSION;
+        __atomic_store_n(&page_->magic, homevpn::STATUS_PAGE_MAGIC, __ATOMIC_RELEASE);
+    } else if (page_->sequence & 1) {
+        // A previous writer died mid-update
+        __atomic_store_n(&page_->sequence, page_->sequence + 1, __ATOMIC_RELEASE);
+    }
+    return true;
+}
+
+void StatusPublisher::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!page_) return;
+
+    // Leave the last state readable but mark it as no longer maintained
+    homevpn::StatusData data = page_->data;
+    data.flags &= ~homevpn::STATUS_PUBLISHER_RUNNING;
+    write(data);
+
+    munmap(page_, sizeof(homevpn::StatusPage));
+    page_ = nullptr;
+    ::close(lock_fd_);
+    lock_fd_ = -1;
+}
+
+void StatusPublisher::publish(const homevpn::StatusData& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (page_) write(data);
+}
+
+void StatusPublisher::write(const homevpn::StatusData& data) {
+    uint32_t sequence = page_->sequence;
+    __atomic_store_n(&page_->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&page_->data, &data, sizeof(data));
+    __atomic_store_n(&page_->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    syscall(SYS_futex, &page_->sequence, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
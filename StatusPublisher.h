@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include "HomeVPNStatusPage.h"
+
+// Writer side of the shared status page (see HomeVPNStatusPage.h)
+class StatusPublisher {
+public:
+    StatusPublisher() = default;
+    ~StatusPublisher();
+
+    StatusPublisher(const StatusPublisher&) = delete;
+    StatusPublisher& operator=(const StatusPublisher&) = delete;
+
+    // Maps the page, creating the file if needed. Fails if another process
+    // holds the page, as the seqlock allows only one writer.
+    bool open(const std::string& path);
+    bool isOpen() const { return page_ != nullptr; }
+    void close();
+
+    // Updates the page under the seqlock and wakes waiting readers
+    void publish(const homevpn::StatusData& data);
+
+    // Why open() failed
+    const std::string& lastError() const { return last_error_; }
+
+private:
+    homevpn::StatusPage* page_ = nullptr;
+    int lock_fd_ = -1;  // flock()ed for as long as the page is open
+    std::string last_error_;
+    std::mutex mutex_;  // the seqlock allows a single writer
+
+    void write(const homevpn::StatusData& data);
+};
@@ -0,0 +1,55 @@
+#!/bin/sh
+# Fake tunnel for trying out and tuning the reconnect policy without a VPN.
+# Configuration (~/.homeVPN):
+#   vpn_connect="/path/to/fake_tunnel.sh up"
+#   vpn_disconnect="/path/to/fake_tunnel.sh down"
+#   check_ip_url="file:///tmp/homevpn-fake-tunnel/ip"
+#   expected_ip="10.99.0.1"
+#   auto_reconnect=1
+# Then script outages from a shell:
+#   fake_tunnel.sh drop      traffic stops but the link stays, like a dead peer
+#   fake_tunnel.sh fail N    the next N connects fail
+#   fake_tunnel.sh status
+# Like wg-quick, "up" fails while the link already exists.
+
+set -eu
+
+DIR=${FAKE_TUNNEL_DIR:-/tmp/homevpn-fake-tunnel}
+IP=${FAKE_TUNNEL_IP:-10.99.0.1}
+mkdir -p "$DIR"
+
+case "${1:-}" in
+    up)
+        if [ -e "$DIR/link" ]; then
+            echo "fake0 already exists" >&2
+            exit 1
+        fi
+        fails=$(cat "$DIR/fail" 2>/dev/null || echo 0)
+        if [ "$fails" -gt 0 ]; then
+            echo $((fails - 1)) > "$DIR/fail"
+            echo "handshake did not complete" >&2
+            exit 1
+        fi
+        touch "$DIR/link"
+        echo "$IP" > "$DIR/ip"
+        ;;
+    down)
+        rm -f "$DIR/link" "$DIR/ip"
+        ;;
+    drop)
+        rm -f "$DIR/ip"
+        ;;
+    fail)
+        echo "${2:?usage: fake_tunnel.sh fail COUNT}" > "$DIR/fail"
+        ;;
+    status)
+        printf 'link: %s  traffic: %s  failing connects: %s\n' \
+            "$([ -e "$DIR/link" ] && echo up || echo down)" \
+            "$([ -e "$DIR/ip" ] && echo yes || echo no)" \
+            "$(cat "$DIR/fail" 2>/dev/null || echo 0)"
+        ;;
+    *)
+        echo "usage: fake_tunnel.sh up|down|drop|fail COUNT|status" >&2
+        exit 2
+        ;;
+esac